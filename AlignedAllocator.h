@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/**
+ * @brief Minimal standard allocator that places its blocks on a given byte boundary
+ * @note used for matrix storage so that every row starts on a cache line and can be fed to SIMD loads
+ */
+template<typename T, size_t ALIGNMENT>
+class AlignedAllocator
+{
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, ALIGNMENT>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    AlignedAllocator( const AlignedAllocator<U, ALIGNMENT> & ) noexcept
+    {}
+
+    T * allocate( size_t count )
+    {
+        return static_cast<T*>( ::operator new( count * sizeof(T), std::align_val_t(ALIGNMENT) ) );
+    }
+
+    void deallocate( T * pointer,
+                     size_t )
+    {
+        ::operator delete( pointer, std::align_val_t(ALIGNMENT) );
+    }
+
+    template<typename U>
+    bool operator==( const AlignedAllocator<U, ALIGNMENT> & ) const noexcept
+    {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=( const AlignedAllocator<U, ALIGNMENT> & ) const noexcept
+    {
+        return false;
+    }
+};
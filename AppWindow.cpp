@@ -4,14 +4,16 @@
 #include <QMessageBox>
 #include <QTime>
 
+#include "MosaicCoupler.h"
+
 AppWindow::AppWindow( QWidget * parent )
     : QMainWindow(parent)
     , ui( new Ui::AppWindow )
     , masterMatrix( 0, 0, 1, HeightMatrix::MASTER )
     , targetMatrix( 0, 0, 1, HeightMatrix::TARGET )
 {
-    //initialize ui and randomizer
-    randomizer.seed( QTime::currentTime().msec() );
+    //initialize ui and generator
+    generator.setSeed( QTime::currentTime().msec() );
     ui->setupUi(this);
 
     //initialize master and target matrices settings widgets (width, height, precision)
@@ -23,10 +25,17 @@ AppWindow::AppWindow( QWidget * parent )
     ui->comboBoxSide->addItem( "Top", (int)COMPARISON_SIDE::TOP );
     ui->comboBoxSide->addItem( "Bottom", (int)COMPARISON_SIDE::BOTTOM );
     ui->comboBoxSide->setCurrentIndex(1);
+    //setting up blend zone falloff selector
+    ui->comboBoxBlendFalloff->addItem( "Smooth", (int)EdgeBlender::SMOOTH );
+    ui->comboBoxBlendFalloff->addItem( "Linear", (int)EdgeBlender::LINEAR );
 
     //grid visibility
     connect( ui->checkBoxMasterShowGrid, SIGNAL( toggled(bool) ), ui->OGL_MasterMatWidget, SLOT( setShowFlatGrid(bool) ) );
     connect( ui->checkBoxTargetShowGrid, SIGNAL( toggled(bool) ), ui->OGL_TargetMatWidget, SLOT( setShowFlatGrid(bool) ) );
+
+    //frame timings
+    connect( ui->checkBoxMasterFrameTimings, SIGNAL( toggled(bool) ), ui->OGL_MasterMatWidget, SLOT( setFrameTimingsEnabled(bool) ) );
+    connect( ui->checkBoxTargetFrameTimings, SIGNAL( toggled(bool) ), ui->OGL_TargetMatWidget, SLOT( setFrameTimingsEnabled(bool) ) );
 }
 
 AppWindow::~AppWindow()
@@ -35,19 +44,15 @@ AppWindow::~AppWindow()
 }
 
 /**
- * @brief fills given matrix with randomized height values
+ * @brief fills given matrix with randomized height values, every matrix gets the next seed.
+ * The seed is printed so that a matrix can be reproduced with HeightMatrixGenerator
  * @param matrix matrix to fill
  */
 void AppWindow::fillMatrix( HeightMatrix & matrix )
 {
-    std::uniform_real_distribution<qreal> heightDistribution( 0.0f, HeightMatrix::MAX_HEIGHT );
-    for ( HeightMatrix::ColumnIterator columnIter = matrix.columnBegin(0); columnIter.isValid(); columnIter++ )
-    {
-        for ( HeightMatrix::RowIterator rowIter = matrix.rowBegin( columnIter.getCurrentIndex() ); rowIter.isValid(); rowIter++ )
-        {
-            *rowIter = heightDistribution(randomizer);
-        }
-    }
+    qInfo( "Generating matrix with seed %llu", (unsigned long long)generator.getSeed() );
+    generator.fill(matrix);
+    generator.setSeed( generator.getSeed() + 1 );
 }
 
 /**
@@ -57,23 +62,7 @@ void AppWindow::fillMatrix( HeightMatrix & matrix )
  */
 COMPARISON_SIDE AppWindow::getSideForTargetMatrix( COMPARISON_SIDE side )
 {
-    if ( side == COMPARISON_SIDE::RIGHT )
-    {
-        side = COMPARISON_SIDE::LEFT;
-    }
-    else if ( side == COMPARISON_SIDE::LEFT )
-    {
-        side = COMPARISON_SIDE::RIGHT;
-    }
-    else if ( side == COMPARISON_SIDE::TOP )
-    {
-        side = COMPARISON_SIDE::BOTTOM;
-    }
-    else if ( side == COMPARISON_SIDE::BOTTOM )
-    {
-        side = COMPARISON_SIDE::TOP;
-    }
-    return side;
+    return HeightMatrix::oppositeSide(side);
 }
 
 /**
@@ -93,6 +82,7 @@ void AppWindow::on_pushButtonMasterMat_clicked()
 
     //update profile view
     updateProfileView( masterMatrix, side );
+    masterMatrix.clearDirtyRects();
 
     //check if the target matrix could bo arranged with new master
     arrangeButtonCheckEnabled();
@@ -108,6 +98,10 @@ void AppWindow::on_pushButtonTargetMat_clicked()
     double precision = ui->comboBoxTargetMatPrec->itemData( ui->comboBoxTargetMatPrec->currentIndex() ).toDouble();
     targetMatrix = HeightMatrix( width, height, precision, HeightMatrix::TARGET );
     fillMatrix(targetMatrix);
+
+    //recorded couplings belong to the replaced matrix
+    ui->OGL_ArrangementViewWidget->clearHistory();
+    updateHistoryButtons();
     COMPARISON_SIDE side = getSideForTargetMatrix( HeightMatrix::sideFrom( ui->comboBoxSide->currentIndex() ) );
 
     //update 3D representation
@@ -115,6 +109,7 @@ void AppWindow::on_pushButtonTargetMat_clicked()
 
     //update profile view
     updateProfileView( targetMatrix, side );
+    targetMatrix.clearDirtyRects();
 
     //check if the new matrix could be arranged with master
     arrangeButtonCheckEnabled();
@@ -155,12 +150,106 @@ void AppWindow::on_pushButtonArrange_clicked()
     //update arrangement view
     COMPARISON_SIDE masterSide = HeightMatrix::sideFrom( ui->comboBoxSide->currentIndex() );
     COMPARISON_SIDE targetSide = getSideForTargetMatrix(masterSide);
+    EdgeBlender::FALLOFF falloff = (EdgeBlender::FALLOFF)ui->comboBoxBlendFalloff->currentData().toInt();
+    ui->OGL_ArrangementViewWidget->setBlendZone( ui->spinBoxBlendWidth->value(), falloff );
     ui->OGL_ArrangementViewWidget->makeCurrent();
     ui->OGL_ArrangementViewWidget->updateProfilesData( masterMatrix, targetMatrix, masterSide, targetSide );
     ui->OGL_ArrangementViewWidget->update();
 
-    //update 3D representation of target matrix after arrangement applied
+    //update 3D representation and profile of target matrix after arrangement applied, only the coupled edge and its band are dirty
     updateMatrixView( ui->OGL_TargetMatWidget, targetMatrix, targetSide );
+    updateProfileView( targetMatrix, targetSide );
+    targetMatrix.clearDirtyRects();
+    updateHistoryButtons();
+}
+
+/**
+ * @brief restores target matrix cells changed by the last arrangement
+ */
+void AppWindow::on_pushButtonUndo_clicked()
+{
+    if ( !ui->OGL_ArrangementViewWidget->undo(targetMatrix) )
+    {
+        qWarning( "Unable to undo the arrangement" );
+    }
+    updateTargetViewsAfterHistoryStep();
+}
+
+/**
+ * @brief applies again the last undone arrangement to the target matrix
+ */
+void AppWindow::on_pushButtonRedo_clicked()
+{
+    if ( !ui->OGL_ArrangementViewWidget->redo(targetMatrix) )
+    {
+        qWarning( "Unable to redo the arrangement" );
+    }
+    updateTargetViewsAfterHistoryStep();
+}
+
+/**
+ * @brief generates a mosaic of tiles with the master matrix settings, couples all its shared edges
+ * and shows the whole mosaic in the master matrix view
+ */
+void AppWindow::on_pushButtonMosaic_clicked()
+{
+    const size_t MOSAIC_ROWS = 20;
+    const size_t MOSAIC_COLUMNS = 20;
+    const size_t MAX_MOSAIC_CELLS = 16 * 1024 * 1024;
+    size_t width = ui->comboBoxMasterMatW->currentText().toInt();
+    size_t height = ui->comboBoxMasterMatH->currentText().toInt();
+    double precision = ui->comboBoxMasterMatPrec->itemData( ui->comboBoxMasterMatPrec->currentIndex() ).toDouble();
+    if ( MOSAIC_ROWS * MOSAIC_COLUMNS * width * height > MAX_MOSAIC_CELLS )
+    {
+        QMessageBox::warning( this, "Warning", "Mosaic tiles are too large, choose a smaller master matrix size" );
+        return;
+    }
+
+    //tiles get consecutive seeds, only the first one is printed
+    qInfo( "Generating mosaic tiles from seed %llu", (unsigned long long)generator.getSeed() );
+    std::vector<HeightMatrix> tiles;
+    tiles.reserve( MOSAIC_ROWS * MOSAIC_COLUMNS );
+    for ( size_t tileIndex = 0; tileIndex < MOSAIC_ROWS * MOSAIC_COLUMNS; tileIndex++ )
+    {
+        tiles.emplace_back( width, height, precision, HeightMatrix::TARGET );
+        generator.fill( tiles.back() );
+        generator.setSeed( generator.getSeed() + 1 );
+    }
+    MosaicCoupler coupler;
+    coupler.couple( tiles, MOSAIC_ROWS, MOSAIC_COLUMNS );
+    qInfo( "Mosaic coupled in %.3f ms", coupler.getTotalMilliseconds() );
+
+    if ( !ui->OGL_MasterMatWidget->updateMosaicData( tiles, MOSAIC_ROWS, MOSAIC_COLUMNS ) )
+    {
+        qWarning( "Unable to build mosaic scene" );
+    }
+}
+
+/**
+ * @brief switches master matrix view between vertex mesh and height texture rendering
+ * @param checked whether height texture rendering is enabled
+ */
+void AppWindow::on_checkBoxMasterHeightTexture_toggled( bool checked )
+{
+    ui->OGL_MasterMatWidget->setHeightTextureMode(checked);
+    if ( masterMatrix.getWidth() != 0 )
+    {
+        updateMatrixView( ui->OGL_MasterMatWidget, masterMatrix, HeightMatrix::sideFrom( ui->comboBoxSide->currentIndex() ) );
+    }
+}
+
+/**
+ * @brief switches target matrix view between vertex mesh and height texture rendering
+ * @param checked whether height texture rendering is enabled
+ */
+void AppWindow::on_checkBoxTargetHeightTexture_toggled( bool checked )
+{
+    ui->OGL_TargetMatWidget->setHeightTextureMode(checked);
+    if ( targetMatrix.getWidth() != 0 )
+    {
+        COMPARISON_SIDE targetSide = getSideForTargetMatrix( HeightMatrix::sideFrom( ui->comboBoxSide->currentIndex() ) );
+        updateMatrixView( ui->OGL_TargetMatWidget, targetMatrix, targetSide );
+    }
 }
 
 /**
@@ -193,6 +282,27 @@ void AppWindow::updateProfileView( const HeightMatrix & MATRIX,
     ui->OGL_ProfileViewWidget->update();
 }
 
+/**
+ * @brief updates 3D representation and profile of target matrix after an undo or redo, only the restored cells are dirty
+ */
+void AppWindow::updateTargetViewsAfterHistoryStep()
+{
+    COMPARISON_SIDE targetSide = getSideForTargetMatrix( HeightMatrix::sideFrom( ui->comboBoxSide->currentIndex() ) );
+    updateMatrixView( ui->OGL_TargetMatWidget, targetMatrix, targetSide );
+    updateProfileView( targetMatrix, targetSide );
+    targetMatrix.clearDirtyRects();
+    updateHistoryButtons();
+}
+
+/**
+ * @brief enables undo and redo buttons when the arrangement history has steps to undo or redo
+ */
+void AppWindow::updateHistoryButtons()
+{
+    ui->pushButtonUndo->setEnabled( ui->OGL_ArrangementViewWidget->canUndo() );
+    ui->pushButtonRedo->setEnabled( ui->OGL_ArrangementViewWidget->canRedo() );
+}
+
 /**
  * @brief checks whether arrange is possible for current precisions of matrices
  */
@@ -222,13 +332,20 @@ void AppWindow::initializeMatrixSettingsWidgets( QComboBox * widthComboBox,
     widthComboBox->addItem("10");
     widthComboBox->addItem("20");
     widthComboBox->addItem("30");
+    widthComboBox->addItem("100");
+    widthComboBox->addItem("1000");
+    widthComboBox->addItem("2000");
     widthComboBox->setCurrentIndex(1);
     heightComboBox->addItem("10");
     heightComboBox->addItem("20");
     heightComboBox->addItem("30");
+    heightComboBox->addItem("100");
+    heightComboBox->addItem("1000");
+    heightComboBox->addItem("2000");
     heightComboBox->setCurrentIndex(1);
     precisionComboBox->addItem("1:1", 1);
     precisionComboBox->addItem("1:2", 2);
+    precisionComboBox->addItem("1:3", 3);
     precisionComboBox->addItem("1:4", 4);
     precisionComboBox->setCurrentIndex(1);
 }
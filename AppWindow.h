@@ -1,9 +1,9 @@
 #pragma once
 
 #include <QMainWindow>
-#include <random>
 
 #include <HeightMatrix.h>
+#include <HeightMatrixGenerator.h>
 
 namespace Ui {
 class AppWindow;
@@ -13,7 +13,7 @@ class QComboBox;
 class MatrixWidget;
 
 /**
- * @brief Program's window representation class, contains ui object, randomizer engine and both master and target matrices
+ * @brief Program's window representation class, contains ui object, matrix generator and both master and target matrices
  */
 class AppWindow: public QMainWindow
 {
@@ -27,6 +27,11 @@ private slots:
     void on_pushButtonTargetMat_clicked();
     void on_comboBoxSide_currentIndexChanged( int sideIndex );
     void on_pushButtonArrange_clicked();
+    void on_pushButtonUndo_clicked();
+    void on_pushButtonRedo_clicked();
+    void on_pushButtonMosaic_clicked();
+    void on_checkBoxMasterHeightTexture_toggled( bool checked );
+    void on_checkBoxTargetHeightTexture_toggled( bool checked );
     void arrangeButtonCheckEnabled();
 
 private:
@@ -41,10 +46,12 @@ private:
                            bool comparisonOnly = false );
     void updateProfileView( const HeightMatrix & MATRIX,
                             COMPARISON_SIDE side );
+    void updateTargetViewsAfterHistoryStep();
+    void updateHistoryButtons();
 
 private:
     Ui::AppWindow * ui;
     HeightMatrix masterMatrix;
     HeightMatrix targetMatrix;
-    std::default_random_engine randomizer;
+    HeightMatrixGenerator generator;
 };
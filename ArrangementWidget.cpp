@@ -1,18 +1,30 @@
 #include "ArrangementWidget.h"
 
+#include <algorithm>
+
+#include "ShaderProgramCache.h"
+
 ArrangementWidget::ArrangementWidget( QWidget * parent )
     : QOpenGLWidget(parent)
     , vboDataValid(false)
+    , changedVerticesFirst(0)
+    , changedVerticesCount(0)
     , projectionHorizontalDistance(0)
 {}
 
 ArrangementWidget::~ArrangementWidget()
 {
-    glDeleteBuffers( 1, &vbo );
+    //buffers and shared program have to be released within the context
+    makeCurrent();
+    vertexBuffer.reset();
+    cameraBlock.reset();
+    shaderProgram.reset();
+    doneCurrent();
 }
 
 /**
- * @brief updates target matrix line for a given side, and updates arrangement view
+ * @brief updates target matrix line for a given side, and updates arrangement view.
+ * Profiles of the same length as the shown ones only refresh heights which have changed, the coupling can be undone
  * @param MASTER_MATRIX master matrix
  * @param targetMatrix target matrix
  * @param masterSide side of the master matrix to couple with
@@ -23,17 +35,21 @@ void ArrangementWidget::updateProfilesData( const HeightMatrix & MASTER_MATRIX,
                                             COMPARISON_SIDE masterSide,
                                             COMPARISON_SIDE targetSide )
 {
-    //first update original target line segment data
-    updateOriginalProfile( targetMatrix, targetSide );
-
-    //then arrange target line segment with adjacent segment of master line
-    updateArrangedProfile( MASTER_MATRIX, targetMatrix, masterSide );
-
-    //make sure both source and arranged profiles are the same size
-    adjustOriginalAndArrangedProfiles();
+    //arrange target line with adjacent line of master and renew target matrix comparison line
+    if ( !history.couple( couplingEngine, MASTER_MATRIX, targetMatrix, masterSide, targetSide ) )
+    {
+        return;
+    }
 
-    //renew target matrix comparison line
-    updateTargetMatrix( targetMatrix, targetSide );
+    const std::vector<float> & ORIGINAL_PROFILE = couplingEngine.getOriginalProfile();
+    const std::vector<float> & ARRANGED_PROFILE = couplingEngine.getArrangedProfile();
+    if ( profilesVertices.size() == ( ORIGINAL_PROFILE.size() + ARRANGED_PROFILE.size() ) * 2 )
+    {
+        //x coordinates are indices, they stay the same for profiles of the same length
+        refreshProfileHeights( ORIGINAL_PROFILE, 0 );
+        refreshProfileHeights( ARRANGED_PROFILE, ORIGINAL_PROFILE.size() );
+        return;
+    }
 
     //add both source and processed lines data to one storage used by VBO during rendering
     mergeOriginalAndArrangedVertices();
@@ -43,39 +59,75 @@ void ArrangementWidget::updateProfilesData( const HeightMatrix & MASTER_MATRIX,
 }
 
 /**
- * @brief initializes OpenGL function pointers, compiles shaders and program
+ * @brief sets the band of target rows or columns the next couplings spread the edge correction over
+ * @param width number of rows or columns including the edge, 1 changes the edge only
+ * @param falloff shape of the correction falloff over the band
+ */
+void ArrangementWidget::setBlendZone( size_t width,
+                                      EdgeBlender::FALLOFF falloff )
+{
+    couplingEngine.setBlendZone( width, falloff );
+}
+
+/**
+ * @brief restores the cells the last applied coupling wrote, arrangement view keeps showing the profiles of the last coupling
+ * @param targetMatrix target matrix the coupling was applied to
+ * @return false if there is nothing to undo or the matrix dimensions changed since the coupling
+ */
+bool ArrangementWidget::undo( HeightMatrix & targetMatrix )
+{
+    return history.undo(targetMatrix);
+}
+
+/**
+ * @brief applies again the cells the last undone coupling wrote
+ * @param targetMatrix target matrix the coupling was applied to
+ * @return false if there is nothing to redo or the matrix dimensions changed since the coupling
+ */
+bool ArrangementWidget::redo( HeightMatrix & targetMatrix )
+{
+    return history.redo(targetMatrix);
+}
+
+bool ArrangementWidget::canUndo() const
+{
+    return history.canUndo();
+}
+
+bool ArrangementWidget::canRedo() const
+{
+    return history.canRedo();
+}
+
+/**
+ * @brief forgets recorded couplings, has to be called when the target matrix is replaced
+ */
+void ArrangementWidget::clearHistory()
+{
+    history.clear();
+}
+
+/**
+ * @brief initializes OpenGL function pointers, buffers and the shared shader program
  */
 void ArrangementWidget::initializeGL()
 {
     //initialize OpenGL function pointers and pre-rendering initialization
     initializeOpenGLFunctions();
-    glGenBuffers( 1, &vbo );
-    glBindBuffer( GL_ARRAY_BUFFER, vbo );
+    vertexBuffer = std::make_unique<StreamingBuffer>( *this, GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW );
+    vertexBuffer->bind();
     glEnableVertexAttribArray(0);
     glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 0, 0 );
+    cameraBlock = std::make_unique<CameraBlock>( *this );
     glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
     glEnable(GL_PROGRAM_POINT_SIZE);
 
-    //compile vertex shader
-    QOpenGLShader vertexShader( QOpenGLShader::Vertex );
-    vertexShader.compileSourceFile( ":/Shaders/grid/vGrid.glsl" );
-    //compile fragment shader
-    QOpenGLShader fragmentShader( QOpenGLShader::Fragment );
-    fragmentShader.compileSourceFile( ":/Shaders/grid/fGrid.glsl" );
-    //link shaders within a program
-    shaderProgram.addShader( &vertexShader );
-    shaderProgram.addShader( &fragmentShader );
-    if ( !shaderProgram.link() )
-    {
-        qWarning( "Unable to link grid shader program" );
-        return;
-    }
+    //grid program is shared with the other widgets
+    shaderProgram = ShaderProgramCache::get( ShaderProgramCache::GRID );
+    uniforms.resolve(*shaderProgram);
 
-    //initialize view matrix
-    shaderProgram.bind();
-    QMatrix4x4 viewMatrix;
+    //initialize view matrix, it is uploaded to the camera block along with the projection matrix
     viewMatrix.lookAt( QVector3D( 0.0f, 0.0f, 1.0f ), QVector3D( 0.0f, 0.0f, 0.0f ), QVector3D( 0.0f, 1.0f, 0.0f ) );
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_view"), viewMatrix );
 }
 
 /**
@@ -84,34 +136,37 @@ void ArrangementWidget::initializeGL()
 void ArrangementWidget::paintGL()
 {
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-    if ( !shaderProgram.bind() )
+    if ( !shaderProgram->bind() )
     {
         qWarning( "Failed to bind shader program" );
         return;
     }
 
     //check whether vbo data is outdated
-    if ( !vboDataValid )
+    if ( !vboDataValid || changedVerticesCount > 0 )
     {
         updateVBO();
-        vboDataValid = true;
     }
 
     //update projection matrix
     QMatrix4x4 projectionMatrix;
     projectionMatrix.ortho( 0.0f, projectionHorizontalDistance, 0.0f, HeightMatrix::MAX_HEIGHT, 0.1f, 2.0f );
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_projection"), projectionMatrix );
+    cameraBlock->update( projectionMatrix, viewMatrix );
+
+    //program is shared with the grids, which leave their own uniform values
+    shaderProgram->setUniformValue( uniforms[UniformLocationCache::SEPARATE_HEIGHTS], false );
+    shaderProgram->setUniformValue( uniforms[UniformLocationCache::APPLY_HEIGHT_COLORING], false );
 
     //render source comparison line (before arrangement is applied) - blue line
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_color"), QVector4D( 0.0f, 0.0f, 1.0f, 1.0f ) );
-    glBindBuffer( GL_ARRAY_BUFFER, vbo );
-    GLsizei numOriginalVertices = (GLsizei)originalProfileVertices.size() / 2;
+    shaderProgram->setUniformValue( uniforms[UniformLocationCache::COLOR], QVector4D( 0.0f, 0.0f, 1.0f, 1.0f ) );
+    vertexBuffer->bind();
+    GLsizei numOriginalVertices = (GLsizei)couplingEngine.getOriginalProfile().size();
     glDrawArrays( GL_LINE_STRIP, 0, numOriginalVertices );
     glDrawArrays( GL_POINTS, 0, numOriginalVertices );
 
     //render comparison line with arrangement applied - purple line
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_color"), QVector4D( 1.0f, 0.0f, 1.0f, 1.0f ) );
-    GLsizei numArrangedVertices = (GLsizei)arrangedProfileVertices.size() / 2;
+    shaderProgram->setUniformValue( uniforms[UniformLocationCache::COLOR], QVector4D( 1.0f, 0.0f, 1.0f, 1.0f ) );
+    GLsizei numArrangedVertices = (GLsizei)couplingEngine.getArrangedProfile().size();
     glDrawArrays( GL_LINE_STRIP, numOriginalVertices, numArrangedVertices );
     glDrawArrays( GL_POINTS, numOriginalVertices, numArrangedVertices );
 
@@ -129,187 +184,78 @@ void ArrangementWidget::resizeGL( int w,
     glViewport( 0, 0, w, h );
 }
 
-/**
- * @brief updates source profile data before coupling has been applied
- * @param MATRIX matrix to take data from
- * @param side side of the matrix
- */
-void ArrangementWidget::updateOriginalProfile( const HeightMatrix & MATRIX,
-                                             COMPARISON_SIDE side )
-{
-    originalProfileVertices.clear();
-
-    if ( side == COMPARISON_SIDE::LEFT || side == COMPARISON_SIDE::RIGHT )
-    {
-        //iteration by first or last column of the matrix
-        HeightMatrix::ConstColumnIterator column = (side == COMPARISON_SIDE::LEFT) ? MATRIX.columnBegin(0) : MATRIX.columnBegin( MATRIX.getWidth() - 1 );
-        originalProfileVertices.reserve( MATRIX.getHeight() * 2 );
-        for ( ; column.isValid(); column++ )
-        {
-            originalProfileVertices.emplace_back( column.getCurrentIndex() );
-            originalProfileVertices.emplace_back( *column );
-        }
-        projectionHorizontalDistance = MATRIX.getHeight();
-    }
-    else
-    {
-        //iteration by first or last row of the matrix
-        HeightMatrix::ConstRowIterator row = (side == COMPARISON_SIDE::TOP) ? MATRIX.rowBegin(0) : MATRIX.rowBegin( MATRIX.getHeight() - 1 );
-        originalProfileVertices.reserve( MATRIX.getWidth() * 2 );
-        for ( ; row.isValid(); row++ )
-        {
-            originalProfileVertices.emplace_back( row.getCurrentIndex() );
-            originalProfileVertices.emplace_back( *row );
-        }
-        projectionHorizontalDistance = MATRIX.getWidth();
-    }
-}
-
-/**
- * @brief updates profile of the target line after coupling with corresponding master's line
- * @param MASTER_MATRIX master matrix
- * @param TARGET_MATRIX target matrix
- * @param masterSide side of the master matrix to couple with
- * @note this function does nothing to target matrix itself, instead it fills arranged line storage with master matrix vertices
- */
-void ArrangementWidget::updateArrangedProfile( const HeightMatrix & MASTER_MATRIX,
-                                               const HeightMatrix & TARGET_MATRIX,
-                                               COMPARISON_SIDE masterSide )
-{
-    arrangedProfileVertices.clear();
-    float masterMatrixPrecision = (float)MASTER_MATRIX.getPrecision();
-    float targetMatrixPrecision = (float)TARGET_MATRIX.getPrecision();
-    unsigned int interpolationSteps = (int)( masterMatrixPrecision / targetMatrixPrecision );
-
-    //comparing LEFT side of master matrix with RIGHT side of target matrix or vice versa
-    if ( masterSide == COMPARISON_SIDE::LEFT || masterSide == COMPARISON_SIDE::RIGHT )
-    {
-        HeightMatrix::ConstColumnIterator masterColumn = (masterSide == COMPARISON_SIDE::LEFT) ? MASTER_MATRIX.columnBegin(0) : MASTER_MATRIX.columnBegin( MASTER_MATRIX.getWidth() - 1 );
-        size_t masterHeight = MASTER_MATRIX.getHeight();
-
-        //fill storage for target matrix arranged side
-        for ( size_t masterLineIndex = 0; masterLineIndex < masterHeight - 1; masterLineIndex++ )
-        {
-            float currentHeight = *masterColumn;
-            masterColumn++;
-            float heightAtNextIndex = *masterColumn;
-            createInterpolants( currentHeight, heightAtNextIndex, interpolationSteps, masterLineIndex * interpolationSteps );
-        }
-
-        //add master side last vertex explicitly
-        arrangedProfileVertices.emplace_back( ( masterHeight - 1 ) * interpolationSteps );
-        arrangedProfileVertices.emplace_back( *masterColumn );
-    }
-
-    //comparing TOP side of master matrix with BOTTOM side of target matrix or vice versa
-    else
-    {
-        HeightMatrix::ConstRowIterator masterRow = (masterSide == COMPARISON_SIDE::TOP) ? MASTER_MATRIX.rowBegin(0) : MASTER_MATRIX.rowBegin( MASTER_MATRIX.getHeight() - 1 );
-        size_t masterWidth = MASTER_MATRIX.getWidth();
-
-        //fill storage for target matrix arranged side
-        for ( size_t masterLineIndex = 0; masterLineIndex < masterWidth - 1; masterLineIndex++ )
-        {
-            float currentHeight = *masterRow;
-            masterRow++;
-            float heightAtNextIndex = *masterRow;
-            createInterpolants( currentHeight, heightAtNextIndex, interpolationSteps, masterLineIndex * interpolationSteps );
-        }
-
-        //add master side last vertex explicitly
-        arrangedProfileVertices.emplace_back( ( masterWidth - 1 ) * interpolationSteps );
-        arrangedProfileVertices.emplace_back( *masterRow );
-    }
-}
-
 /**
  * @brief merges both original and arranged vertices data into one storage
  */
 void ArrangementWidget::mergeOriginalAndArrangedVertices()
 {
+    const std::vector<float> & ORIGINAL_PROFILE = couplingEngine.getOriginalProfile();
+    const std::vector<float> & ARRANGED_PROFILE = couplingEngine.getArrangedProfile();
     profilesVertices.clear();
-    profilesVertices.reserve( originalProfileVertices.size() + arrangedProfileVertices.size() );
-    profilesVertices.insert( profilesVertices.end(), originalProfileVertices.begin(), originalProfileVertices.end() );
-    profilesVertices.insert( profilesVertices.end(), arrangedProfileVertices.begin(), arrangedProfileVertices.end() );
-}
-
-/**
- * @brief buffers data from profiles to vertex buffer object
- */
-void ArrangementWidget::updateVBO()
-{
-    glBindBuffer( GL_ARRAY_BUFFER, vbo );
-    glBufferData( GL_ARRAY_BUFFER, profilesVertices.size() * sizeof(float), profilesVertices.data(), GL_STATIC_DRAW );
-    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    profilesVertices.reserve( ( ORIGINAL_PROFILE.size() + ARRANGED_PROFILE.size() ) * 2 );
+    bufferProfileVertices(ORIGINAL_PROFILE);
+    bufferProfileVertices(ARRANGED_PROFILE);
+    projectionHorizontalDistance = ORIGINAL_PROFILE.size();
 }
 
 /**
- * @brief adjust arranged line profile storage to fit with original
+ * @brief appends (x;y) vertices of a profile to the common storage, X coordinate is the index of a height value
+ * @param PROFILE height values of the profile
  */
-void ArrangementWidget::adjustOriginalAndArrangedProfiles()
+void ArrangementWidget::bufferProfileVertices( const std::vector<float> & PROFILE )
 {
-    //arranged line is not less than original -> cutting down to the target matrix line length
-    if ( arrangedProfileVertices.size() >= originalProfileVertices.size() )
-    {
-        arrangedProfileVertices.resize( originalProfileVertices.size() );
-    }
-    //arranged line is a part of the original -> expand with vertices from the original line
-    else
+    for ( size_t index = 0; index < PROFILE.size(); index++ )
     {
-        arrangedProfileVertices.insert( arrangedProfileVertices.end(),
-                                        originalProfileVertices.begin() + arrangedProfileVertices.size(),
-                                        originalProfileVertices.end() );
+        profilesVertices.emplace_back( index );         //x
+        profilesVertices.emplace_back( PROFILE[index] ); //y
     }
 }
 
 /**
- * @brief create interpolated vertices to match the target's matrix precision and stores them in arranged profile buffer
- * @param value1 first value
- * @param value2 second value
- * @param steps number of steps between two values
- * @param xOffset position offset of a new interpolant value on X axis
+ * @brief overwrites heights of a profile in the common storage and widens the range of vertices to upload by those that differ
+ * @param PROFILE height values of the profile
+ * @param firstVertex index of the first vertex of the profile in the common storage
  */
-void ArrangementWidget::createInterpolants( float value1,
-                                            float value2,
-                                            unsigned int steps,
-                                            size_t xOffset )
+void ArrangementWidget::refreshProfileHeights( const std::vector<float> & PROFILE,
+                                               size_t firstVertex )
 {
-    float stepDistance = 1.0f / steps;
-    for ( size_t step = 0; step < steps; step++ )
+    for ( size_t index = 0; index < PROFILE.size(); index++ )
     {
-        float interpolation = stepDistance * step;
-        float targetHeight = ( 1.0f - interpolation ) * value1
-                             +
-                             interpolation * value2;
-        arrangedProfileVertices.emplace_back( xOffset + step ); //x
-        arrangedProfileVertices.emplace_back( targetHeight );   //y
+        float & height = profilesVertices[( firstVertex + index ) * 2 + 1];
+        if ( height == PROFILE[index] )
+        {
+            continue;
+        }
+        height = PROFILE[index];
+        size_t vertex = firstVertex + index;
+        if ( changedVerticesCount == 0 )
+        {
+            changedVerticesFirst = vertex;
+        }
+        //vertices are visited in ascending order within a call, an earlier call may have left a range behind
+        size_t changedEnd = std::max( changedVerticesFirst + changedVerticesCount, vertex + 1 );
+        changedVerticesFirst = std::min( changedVerticesFirst, vertex );
+        changedVerticesCount = changedEnd - changedVerticesFirst;
     }
 }
 
 /**
- * @brief update target matrix line for a given side with values stored in arranged profile storage
- * @param matrix matrix to update
- * @param side side to update
+ * @brief uploads the whole profiles storage after its layout has changed, otherwise only the vertices which differ
  */
-void ArrangementWidget::updateTargetMatrix( HeightMatrix & matrix,
-                                            COMPARISON_SIDE side )
+void ArrangementWidget::updateVBO()
 {
-    if ( side == COMPARISON_SIDE::LEFT || side == COMPARISON_SIDE::RIGHT )
+    //(x;y) vertices
+    const GLsizeiptr VERTEX_SIZE = 2 * sizeof(float);
+    if ( !vboDataValid )
     {
-        HeightMatrix::ColumnIterator column = (side == COMPARISON_SIDE::LEFT) ? matrix.columnBegin(0) : matrix.columnBegin( matrix.getWidth() - 1 );
-        //all odd indices for each pair in profile vector represents point height, thus +1 is applied, X coord is left old
-        for ( ; column.isValid(); column++ )
-        {
-            *column = arrangedProfileVertices[ column.getCurrentIndex() * 2 + 1 ];
-        }
+        vertexBuffer->assign( profilesVertices.data(), profilesVertices.size() * sizeof(float) );
     }
     else
     {
-        HeightMatrix::RowIterator row = (side == COMPARISON_SIDE::TOP) ? matrix.rowBegin(0) : matrix.rowBegin( matrix.getHeight() - 1 );
-        //all odd indices for each pair in profile vector represents point height, thus +1 is applied, X coord is left old
-        for ( ; row.isValid(); row++ )
-        {
-            *row = arrangedProfileVertices[ row.getCurrentIndex() * 2 + 1 ];
-        }
+        vertexBuffer->updateRange( changedVerticesFirst * VERTEX_SIZE, profilesVertices.data() + changedVerticesFirst * 2,
+                                   changedVerticesCount * VERTEX_SIZE );
     }
+    vboDataValid = true;
+    changedVerticesCount = 0;
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
 }
@@ -1,16 +1,24 @@
 #pragma once
 
 #include <QOpenGLWidget>
-#include <QOpenGLFunctions>
+#include <QOpenGLFunctions_4_3_Core>
 #include <QOpenGLShaderProgram>
 #include <vector>
+#include <memory>
 
 #include "HeightMatrix.h"
+#include "StreamingBuffer.h"
+#include "CameraBlock.h"
+#include "UniformLocationCache.h"
+#include "CouplingEngine.h"
+#include "CouplingHistory.h"
 
 /**
- * @brief View widget of the master-target arrangement for the chosen side
+ * @brief View widget of the master-target arrangement for the chosen side.
+ * Profiles persist in the vertex buffer, after a coupling of the same side length only heights that differ are uploaded.
+ * Couplings are recorded in an undo history of the target matrix
  */
-class ArrangementWidget : public QOpenGLWidget, public QOpenGLFunctions
+class ArrangementWidget : public QOpenGLWidget, public QOpenGLFunctions_4_3_Core
 {
 public:
     explicit ArrangementWidget( QWidget * parent = 0 );
@@ -19,32 +27,36 @@ public:
                              HeightMatrix & targetMatrix,
                              COMPARISON_SIDE masterSide,
                              COMPARISON_SIDE targetSide );
+    void setBlendZone( size_t width,
+                       EdgeBlender::FALLOFF falloff );
+    bool undo( HeightMatrix & targetMatrix );
+    bool redo( HeightMatrix & targetMatrix );
+    bool canUndo() const;
+    bool canRedo() const;
+    void clearHistory();
 private:
     void initializeGL() override;
     void paintGL() override;
     void resizeGL( int w,
                    int h ) override;
-    void updateOriginalProfile( const HeightMatrix & MATRIX,
-                                COMPARISON_SIDE side );
-    void updateArrangedProfile( const HeightMatrix & MASTER_MATRIX,
-                                const HeightMatrix & TARGET_MATRIX,
-                                COMPARISON_SIDE masterSide );
     void mergeOriginalAndArrangedVertices();
+    void bufferProfileVertices( const std::vector<float> & PROFILE );
+    void refreshProfileHeights( const std::vector<float> & PROFILE,
+                                size_t firstVertex );
     void updateVBO();
-    void adjustOriginalAndArrangedProfiles();
-    void createInterpolants( float value1,
-                             float value2,
-                             unsigned int steps,
-                             size_t xOffset );
-    void updateTargetMatrix( HeightMatrix & matrix,
-                             COMPARISON_SIDE side );
 
 private:
-    QOpenGLShaderProgram shaderProgram;
-    GLuint vbo;
+    std::shared_ptr<QOpenGLShaderProgram> shaderProgram;
+    UniformLocationCache uniforms;
+    std::unique_ptr<CameraBlock> cameraBlock;
+    QMatrix4x4 viewMatrix;
+    std::unique_ptr<StreamingBuffer> vertexBuffer;
     bool vboDataValid;
+    //vertices whose heights differ from the uploaded ones while the buffer layout stayed the same
+    size_t changedVerticesFirst;
+    size_t changedVerticesCount;
     std::vector<float> profilesVertices;
-    std::vector<float> originalProfileVertices;
-    std::vector<float> arrangedProfileVertices;
+    CouplingEngine couplingEngine;
+    CouplingHistory history;
     size_t projectionHorizontalDistance;
 };
@@ -0,0 +1,43 @@
+#include "CameraBlock.h"
+
+#include <cstring>
+
+namespace
+{
+    //two column-major mat4, std140 puts them back to back without padding
+    constexpr size_t MATRIX_SIZE = 16 * sizeof(float);
+}
+
+/**
+ * @param functions OpenGL functions of the current context
+ */
+CameraBlock::CameraBlock( QOpenGLFunctions_4_3_Core & functions )
+    : functions(functions)
+    , buffer( functions, GL_UNIFORM_BUFFER, GL_DYNAMIC_DRAW )
+{
+    float data[32];
+    std::memcpy( data, projectionMatrix.constData(), MATRIX_SIZE );
+    std::memcpy( data + 16, viewMatrix.constData(), MATRIX_SIZE );
+    buffer.assign( data, sizeof(data) );
+    functions.glBindBufferBase( GL_UNIFORM_BUFFER, BINDING, buffer.getId() );
+}
+
+/**
+ * @brief uploads matrices which differ from the ones uploaded before
+ * @param PROJECTION_MATRIX projection matrix
+ * @param VIEW_MATRIX view matrix
+ */
+void CameraBlock::update( const QMatrix4x4 & PROJECTION_MATRIX,
+                          const QMatrix4x4 & VIEW_MATRIX )
+{
+    if ( PROJECTION_MATRIX != projectionMatrix )
+    {
+        projectionMatrix = PROJECTION_MATRIX;
+        buffer.updateRange( 0, projectionMatrix.constData(), MATRIX_SIZE );
+    }
+    if ( VIEW_MATRIX != viewMatrix )
+    {
+        viewMatrix = VIEW_MATRIX;
+        buffer.updateRange( MATRIX_SIZE, viewMatrix.constData(), MATRIX_SIZE );
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QMatrix4x4>
+
+#include "StreamingBuffer.h"
+
+/**
+ * @brief std140 uniform buffer with projection and view matrices, bound to CameraBlock of every shader program of a context.
+ * Matrices are uploaded once per frame instead of being set on every program before every draw
+ */
+class CameraBlock
+{
+public:
+    //binding point declared by CameraBlock in the shaders
+    constexpr static GLuint BINDING = 0;
+
+    explicit CameraBlock( QOpenGLFunctions_4_3_Core & functions );
+    void update( const QMatrix4x4 & PROJECTION_MATRIX,
+                 const QMatrix4x4 & VIEW_MATRIX );
+
+private:
+    QOpenGLFunctions_4_3_Core & functions;
+    StreamingBuffer buffer;
+    QMatrix4x4 projectionMatrix;
+    QMatrix4x4 viewMatrix;
+};
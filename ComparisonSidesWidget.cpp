@@ -1,15 +1,30 @@
 #include "ComparisonSidesWidget.h"
 
+#include <algorithm>
+
+#include "ShaderProgramCache.h"
+
 ComparisonSidesWidget::ComparisonSidesWidget( QWidget * parent )
     : QOpenGLWidget(parent)
     , vboDataValid(false)
+    , changedVerticesFirst(0)
+    , changedVerticesCount(0)
+    , masterSide(COMPARISON_SIDE::LEFT)
+    , masterMatrixId(0)
     , projectionHorizontalDistanceMaster(0)
+    , targetSide(COMPARISON_SIDE::LEFT)
+    , targetMatrixId(0)
     , projectionHorizontalDistanceTarget(0)
 {}
 
 ComparisonSidesWidget::~ComparisonSidesWidget()
 {
-    glDeleteBuffers( 1, &vbo );
+    //buffers and shared program have to be released within the context
+    makeCurrent();
+    vertexBuffer.reset();
+    cameraBlock.reset();
+    shaderProgram.reset();
+    doneCurrent();
 }
 
 /**
@@ -19,35 +34,20 @@ void ComparisonSidesWidget::initializeGL()
 {
     //initialize OpenGL functions and pre-rendering setup
     initializeOpenGLFunctions();
-    glGenBuffers( 1, &vbo );
-    glBindBuffer( GL_ARRAY_BUFFER, vbo );
+    vertexBuffer = std::make_unique<StreamingBuffer>( *this, GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW );
+    vertexBuffer->bind();
     glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 0, 0 );
     glEnableVertexAttribArray(0);
+    cameraBlock = std::make_unique<CameraBlock>( *this );
     glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
     glEnable(GL_PROGRAM_POINT_SIZE);
 
-    //create shaders
-    QOpenGLShader vertexShader( QOpenGLShader::Vertex );
-    vertexShader.compileSourceFile(":/Shaders/grid/vGrid.glsl");
-    QOpenGLShader fragmentShader( QOpenGLShader::Fragment );
-    fragmentShader.compileSourceFile(":/Shaders/grid/fGrid.glsl");
-    //create shader program
-    shaderProgram.addShader( &vertexShader );
-    shaderProgram.addShader( &fragmentShader );
-    if ( !shaderProgram.link() )
-    {
-        qWarning("Unable to link comparison widget program");
-    }
+    //grid program is shared with the other widgets
+    shaderProgram = ShaderProgramCache::get( ShaderProgramCache::GRID );
+    uniforms.resolve(*shaderProgram);
 
-    //initialize view matrix
-    if ( !shaderProgram.bind() )
-    {
-        qWarning( "Error during comparison widget program binding" );
-        return;
-    }
-    QMatrix4x4 viewMatrix;
+    //initialize view matrix, it is uploaded to the camera block along with the projection matrix
     viewMatrix.lookAt( QVector3D( 0.0f, 0.0f, 1.0f ), QVector3D( 0.0f, 0.0f, 0.0f ), QVector3D( 0.0f, 1.0f, 0.0f ) );
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_view"), viewMatrix );
 }
 
 /**
@@ -56,34 +56,37 @@ void ComparisonSidesWidget::initializeGL()
 void ComparisonSidesWidget::paintGL()
 {
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-    if ( !shaderProgram.bind() )
+    if ( !shaderProgram->bind() )
     {
         qWarning( "Error during comparison widget program binding" );
         return;
     }
     //check whether vbo data is outdated
-    if ( !vboDataValid )
+    if ( !vboDataValid || changedVerticesCount > 0 )
     {
         updateVBO();
-        vboDataValid = true;
     }
 
     //update projection matrix
     QMatrix4x4 projectionMatrix;
     float projectionRightPlane = std::max( projectionHorizontalDistanceMaster, projectionHorizontalDistanceTarget );
     projectionMatrix.ortho( 0.0f, projectionRightPlane, 0.0f, HeightMatrix::MAX_HEIGHT, 0.1f, 2.0f );
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_projection"), projectionMatrix );
+    cameraBlock->update( projectionMatrix, viewMatrix );
+
+    //program is shared with the grids, which leave their own uniform values
+    shaderProgram->setUniformValue( uniforms[UniformLocationCache::SEPARATE_HEIGHTS], false );
+    shaderProgram->setUniformValue( uniforms[UniformLocationCache::APPLY_HEIGHT_COLORING], false );
 
     //render maser matrix profile - red line
     GLsizei numMasterVertices = (GLsizei)masterProfileVertices.size() / 2;
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_color"), QVector4D( 1.0f, 0.0f, 0.0f, 1.0f ) );
-    glBindBuffer( GL_ARRAY_BUFFER, vbo );
+    shaderProgram->setUniformValue( uniforms[UniformLocationCache::COLOR], QVector4D( 1.0f, 0.0f, 0.0f, 1.0f ) );
+    vertexBuffer->bind();
     glDrawArrays( GL_LINE_STRIP, 0, numMasterVertices );
     glDrawArrays( GL_POINTS, 0, numMasterVertices );
 
     //render target matrix profile - blue line
     GLsizei numTargetVertices = (GLsizei)targetProfileVertices.size() / 2;
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_color"), QVector4D( 0.0f, 0.0f, 1.0f, 1.0f ) );
+    shaderProgram->setUniformValue( uniforms[UniformLocationCache::COLOR], QVector4D( 0.0f, 0.0f, 1.0f, 1.0f ) );
     glDrawArrays( GL_LINE_STRIP, numMasterVertices, numTargetVertices );
     glDrawArrays( GL_POINTS, numMasterVertices, numTargetVertices );
 }
@@ -99,7 +102,8 @@ void ComparisonSidesWidget::resizeGL( int w, int h )
 }
 
 /**
- * @brief updates profile buffer dependent on a given matrix
+ * @brief updates profile buffer dependent on a given matrix.
+ * A profile of the same matrix and side is refreshed only along the dirty span of the edge, nothing is uploaded when the edge is clean
  * @param MATRIX matrix
  * @param side side of the given matrix
  */
@@ -110,10 +114,38 @@ void ComparisonSidesWidget::updateProfileBuffer( const HeightMatrix & MATRIX,
     {
         return;
     }
-    std::vector<float> & vertices = (MATRIX.getType() == HeightMatrix::MASTER) ? masterProfileVertices : targetProfileVertices;
-    vertices.clear();
-    int & projectionHorizontalDistance = (MATRIX.getType() == HeightMatrix::MASTER) ? projectionHorizontalDistanceMaster : projectionHorizontalDistanceTarget;
-    createComparisonLineData( MATRIX, side, vertices, projectionHorizontalDistance );
+    bool isMaster = MATRIX.getType() == HeightMatrix::MASTER;
+    std::vector<float> & vertices = isMaster ? masterProfileVertices : targetProfileVertices;
+    int & projectionHorizontalDistance = isMaster ? projectionHorizontalDistanceMaster : projectionHorizontalDistanceTarget;
+    COMPARISON_SIDE & profileSide = isMaster ? masterSide : targetSide;
+    uint64_t & profileMatrixId = isMaster ? masterMatrixId : targetMatrixId;
+    const size_t PROFILE_LENGTH = MATRIX.getEdgeProfile(side).size();
+    if ( side == profileSide && MATRIX.getId() == profileMatrixId && vertices.size() == PROFILE_LENGTH * 2 )
+    {
+        size_t first = 0;
+        size_t count = 0;
+        if ( !MATRIX.getDirtyEdgeSpan( side, first, count ) )
+        {
+            return;
+        }
+        createComparisonLineData( MATRIX, side, first, count, vertices, projectionHorizontalDistance );
+
+        //refreshed vertices are copied to the common storage, buffer layout stays the same
+        size_t mergedFirst = ( isMaster ? 0 : masterProfileVertices.size() / 2 ) + first;
+        std::copy( vertices.begin() + first * 2, vertices.begin() + ( first + count ) * 2, profilesVertices.begin() + mergedFirst * 2 );
+        size_t changedEnd = mergedFirst + count;
+        if ( changedVerticesCount > 0 )
+        {
+            changedEnd = std::max( changedEnd, changedVerticesFirst + changedVerticesCount );
+            mergedFirst = std::min( mergedFirst, changedVerticesFirst );
+        }
+        changedVerticesFirst = mergedFirst;
+        changedVerticesCount = changedEnd - mergedFirst;
+        return;
+    }
+    profileSide = side;
+    profileMatrixId = MATRIX.getId();
+    createComparisonLineData( MATRIX, side, 0, PROFILE_LENGTH, vertices, projectionHorizontalDistance );
 
     //add both master and target profile lines data to one storage used by VBO during rendering
     mergeMasterAndTargetProfilesVertices();
@@ -134,56 +166,50 @@ void ComparisonSidesWidget::mergeMasterAndTargetProfilesVertices()
 }
 
 /**
- * @brief updates vertex buffer with data stored in profiles storage
+ * @brief uploads the whole profiles storage after its layout has changed, otherwise only the refreshed vertices
  */
 void ComparisonSidesWidget::updateVBO()
 {
-    glBindBuffer( GL_ARRAY_BUFFER, vbo );
-    glBufferData( GL_ARRAY_BUFFER, profilesVertices.size() * sizeof(float), profilesVertices.data(), GL_STATIC_DRAW );
+    const GLsizeiptr VERTEX_SIZE = sizeof(ProfileVertex);
+    if ( !vboDataValid )
+    {
+        vertexBuffer->assign( profilesVertices.data(), profilesVertices.size() * sizeof(float) );
+    }
+    else
+    {
+        vertexBuffer->updateRange( changedVerticesFirst * VERTEX_SIZE, profilesVertices.data() + changedVerticesFirst * 2,
+                                   changedVerticesCount * VERTEX_SIZE );
+    }
+    vboDataValid = true;
+    changedVerticesCount = 0;
     glBindBuffer( GL_ARRAY_BUFFER, 0 );
 }
 
 /**
- * @brief stores profile vertices of a given side from a given matrix to a given storage
+ * @brief stores a range of profile vertices of a given side from a given matrix to a given storage,
+ * the storage is sized to the whole profile
  * @param MATRIX matrix
  * @param side side of the matrix
+ * @param first index of the first profile vertex to store
+ * @param count number of profile vertices to store
  * @param vertices storage to fill
  * @param projectionDistance distance used in projection matrix dependent on the profile length
  */
 void ComparisonSidesWidget::createComparisonLineData( const HeightMatrix & MATRIX,
                                                       COMPARISON_SIDE side,
+                                                      size_t first,
+                                                      size_t count,
                                                       std::vector<float> & vertices,
                                                       int & projectionDistance )
 {
     float precision = (float)MATRIX.getPrecision();
-    if ( side == COMPARISON_SIDE::LEFT || side == COMPARISON_SIDE::RIGHT )
-    {
-        HeightMatrix::ConstColumnIterator column = (side == COMPARISON_SIDE::LEFT) ? MATRIX.columnBegin(0) : MATRIX.columnBegin( MATRIX.getWidth() - 1 );
-        for ( ; column.isValid(); column++ )
-        {
-            bufferProfileVertex( vertices, ProfileVertex{ column.getCurrentIndex() * precision, *column } );
-        }
-        projectionDistance = MATRIX.getHeight() * precision;
-    }
-    else
+    const std::vector<float> & PROFILE = MATRIX.getEdgeProfile(side);
+    vertices.resize( PROFILE.size() * 2 );
+    for ( size_t index = first; index < first + count; index++ )
     {
-        HeightMatrix::ConstRowIterator row = (side == COMPARISON_SIDE::TOP) ? MATRIX.rowBegin(0) : MATRIX.rowBegin( MATRIX.getHeight() - 1 );
-        for ( ; row.isValid(); row++ )
-        {
-            bufferProfileVertex( vertices, ProfileVertex{ row.getCurrentIndex() * precision, *row } );
-        }
-        projectionDistance = MATRIX.getWidth() * precision;
+        vertices[index * 2] = index * precision;
+        vertices[index * 2 + 1] = PROFILE[index];
     }
-}
-
-/**
- * @brief helper function to buffer vertex into a given storage
- * @param vertices buffer of vertices
- * @param vertex a profile line vertex
- */
-void ComparisonSidesWidget::bufferProfileVertex( std::vector<float> & vertices,
-                                                 ProfileVertex && vertex )
-{
-    vertices.emplace_back( vertex.x );
-    vertices.emplace_back( vertex.y );
+    bool isVerticalSide = side == COMPARISON_SIDE::LEFT || side == COMPARISON_SIDE::RIGHT;
+    projectionDistance = ( isVerticalSide ? MATRIX.getHeight() : MATRIX.getWidth() ) * precision;
 }
@@ -1,16 +1,21 @@
 #pragma once
 
 #include <QOpenGLWidget>
-#include <QOpenGLFunctions>
+#include <QOpenGLFunctions_4_3_Core>
 #include <QOpenGLShaderProgram>
 #include <vector>
+#include <memory>
 
 #include "HeightMatrix.h"
+#include "StreamingBuffer.h"
+#include "CameraBlock.h"
+#include "UniformLocationCache.h"
 
 /**
- * @brief View widget of the master and target matrices original profiles for the chosen side
+ * @brief View widget of the master and target matrices original profiles for the chosen side.
+ * Profiles persist in the vertex buffer, a profile of the same side is refreshed only along the dirty span of its edge
  */
-class ComparisonSidesWidget : public QOpenGLWidget, public QOpenGLFunctions
+class ComparisonSidesWidget : public QOpenGLWidget, public QOpenGLFunctions_4_3_Core
 {
 public:
     explicit ComparisonSidesWidget( QWidget * parent = 0 );
@@ -28,21 +33,31 @@ private:
     void resizeGL( int w, int h ) override;
 
     void mergeMasterAndTargetProfilesVertices();
-    void bufferProfileVertex( std::vector<float> & profilesVertices,
-                              ProfileVertex && vertex);
     void updateVBO();
     void createComparisonLineData( const HeightMatrix & MATRIX,
                                    COMPARISON_SIDE side,
+                                   size_t first,
+                                   size_t count,
                                    std::vector<float> & profilesVertices,
                                    int & projectionDistance );
 private:
-    QOpenGLShaderProgram shaderProgram;
-    GLuint vbo;
+    std::shared_ptr<QOpenGLShaderProgram> shaderProgram;
+    UniformLocationCache uniforms;
+    std::unique_ptr<CameraBlock> cameraBlock;
+    QMatrix4x4 viewMatrix;
+    std::unique_ptr<StreamingBuffer> vertexBuffer;
     bool vboDataValid;
+    //vertices refreshed since the last upload while the buffer layout stayed the same
+    size_t changedVerticesFirst;
+    size_t changedVerticesCount;
     std::vector<float> profilesVertices;
 
     std::vector<float> masterProfileVertices;
+    COMPARISON_SIDE masterSide;
+    uint64_t masterMatrixId;
     int projectionHorizontalDistanceMaster;
     std::vector<float> targetProfileVertices;
+    COMPARISON_SIDE targetSide;
+    uint64_t targetMatrixId;
     int projectionHorizontalDistanceTarget;
 };
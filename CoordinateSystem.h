@@ -3,6 +3,8 @@
 #include <QOpenGLFunctions_4_3_Core>
 #include <memory>
 
+#include "StreamingBuffer.h"
+
 class QOpenGLShaderProgram;
 
 /**
@@ -14,12 +16,11 @@ public:
     CoordinateSystem( QOpenGLShaderProgram & shaderProgram,
                       QOpenGLFunctions_4_3_Core & functions );
     ~CoordinateSystem();
-    void draw( const QMatrix4x4 & PROJECTION_MATRIX,
-               const QMatrix4x4 & VIEW_MATRIX );
+    void draw();
 
 private:
     QOpenGLShaderProgram & shaderProgram;
     QOpenGLFunctions_4_3_Core & functions;
     GLuint vao;
-    GLuint vbo;
+    StreamingBuffer colorsBuffer;
 };
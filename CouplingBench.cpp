@@ -0,0 +1,468 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "CouplingEngine.h"
+#include "GridMesh.h"
+#include "HeightMatrix.h"
+#include "HeightMatrixGenerator.h"
+#include "PolyphaseResampler.h"
+
+//----allocation accounting---------
+//every global allocation of the process is counted, measurements read the difference around a benchmarked call
+
+namespace
+{
+    std::atomic<uint64_t> allocatedBytes( 0 );
+    std::atomic<uint64_t> allocationsCount( 0 );
+
+    void * countedAllocate( size_t size )
+    {
+        allocatedBytes.fetch_add( size, std::memory_order_relaxed );
+        allocationsCount.fetch_add( 1, std::memory_order_relaxed );
+        void * pointer = std::malloc( size != 0 ? size : 1 );
+        if ( pointer == nullptr )
+        {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void * countedAllocateAligned( size_t size,
+                                   std::align_val_t alignment )
+    {
+        allocatedBytes.fetch_add( size, std::memory_order_relaxed );
+        allocationsCount.fetch_add( 1, std::memory_order_relaxed );
+        size_t alignmentBytes = (size_t)alignment;
+        size_t alignedSize = ( std::max( size, (size_t)1 ) + alignmentBytes - 1 ) / alignmentBytes * alignmentBytes;
+#ifdef _MSC_VER
+        void * pointer = _aligned_malloc( alignedSize, alignmentBytes );
+#else
+        void * pointer = std::aligned_alloc( alignmentBytes, alignedSize );
+#endif
+        if ( pointer == nullptr )
+        {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void releaseAligned( void * pointer )
+    {
+#ifdef _MSC_VER
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+}
+
+void * operator new( size_t size )
+{
+    return countedAllocate(size);
+}
+
+void * operator new[]( size_t size )
+{
+    return countedAllocate(size);
+}
+
+void * operator new( size_t size,
+                     std::align_val_t alignment )
+{
+    return countedAllocateAligned( size, alignment );
+}
+
+void * operator new[]( size_t size,
+                       std::align_val_t alignment )
+{
+    return countedAllocateAligned( size, alignment );
+}
+
+void operator delete( void * pointer ) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[]( void * pointer ) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete( void * pointer,
+                      size_t ) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[]( void * pointer,
+                        size_t ) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete( void * pointer,
+                      std::align_val_t ) noexcept
+{
+    releaseAligned(pointer);
+}
+
+void operator delete[]( void * pointer,
+                        std::align_val_t ) noexcept
+{
+    releaseAligned(pointer);
+}
+
+void operator delete( void * pointer,
+                      size_t,
+                      std::align_val_t ) noexcept
+{
+    releaseAligned(pointer);
+}
+
+void operator delete[]( void * pointer,
+                        size_t,
+                        std::align_val_t ) noexcept
+{
+    releaseAligned(pointer);
+}
+
+//----benchmark harness---------
+
+namespace
+{
+    const size_t MATRIX_SIZES[] = { 10, 64, 256, 1024, 4096, 16384 };
+    const unsigned PRECISION_RATIOS[] = { 1, 2, 4 };
+    //fractional ratio of the polyphase cases, every 2 coarser cells cover 3 finer ones
+    const unsigned FRACTIONAL_RATIO_CELLS = 2;
+    const unsigned FRACTIONAL_RATIO_STEPS = 3;
+    const char * const SIDE_NAMES[] = { "LEFT", "RIGHT", "TOP", "BOTTOM" };
+    //rows or columns of the blend zone coupling case
+    const size_t BLEND_WIDTH = 64;
+    constexpr unsigned MIN_ITERATIONS = 3;
+
+    /**
+     * @brief Timing and allocation figures of one benchmark case
+     */
+    struct BenchResult
+    {
+        std::string name;
+        size_t width;
+        size_t height;
+        std::string side;
+        //precision ratio is precisionCells:precisionRatio
+        unsigned precisionCells;
+        unsigned precisionRatio;
+        size_t cells;
+        unsigned iterations;
+        double nsPerIteration;
+        uint64_t bytesAllocated;
+        uint64_t allocations;
+    };
+
+    /**
+     * @brief Command line settings of the benchmark run
+     */
+    struct BenchSettings
+    {
+        size_t maxSize = 16384;
+        double minTimeSeconds = 0.2;
+        std::string outputPath;
+    };
+
+    /**
+     * @brief runs a function repeatedly after one warm-up call until both the minimal time and the minimal iterations count are reached
+     * @param FUNCTION benchmarked call
+     * @param SETTINGS run settings
+     * @param result result to fill with the fastest iteration time and allocations of the last iteration
+     */
+    void measure( const std::function<void()> & FUNCTION,
+                  const BenchSettings & SETTINGS,
+                  BenchResult & result )
+    {
+        using Clock = std::chrono::steady_clock;
+        FUNCTION();
+
+        double bestNs = 0.0;
+        double totalSeconds = 0.0;
+        result.iterations = 0;
+        while ( result.iterations < MIN_ITERATIONS || totalSeconds < SETTINGS.minTimeSeconds )
+        {
+            uint64_t bytesBefore = allocatedBytes.load( std::memory_order_relaxed );
+            uint64_t allocationsBefore = allocationsCount.load( std::memory_order_relaxed );
+            Clock::time_point start = Clock::now();
+            FUNCTION();
+            Clock::time_point stop = Clock::now();
+            result.bytesAllocated = allocatedBytes.load( std::memory_order_relaxed ) - bytesBefore;
+            result.allocations = allocationsCount.load( std::memory_order_relaxed ) - allocationsBefore;
+
+            double iterationNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>( stop - start ).count();
+            bestNs = ( result.iterations == 0 ) ? iterationNs : std::min( bestNs, iterationNs );
+            totalSeconds += iterationNs * 1e-9;
+            result.iterations++;
+        }
+        result.nsPerIteration = bestNs;
+    }
+
+    /**
+     * @brief appends (x;y) profile vertices the same way the arrangement widget does
+     */
+    void bufferProfileVertices( const std::vector<float> & PROFILE,
+                                std::vector<float> & vertices )
+    {
+        for ( size_t index = 0; index < PROFILE.size(); index++ )
+        {
+            vertices.emplace_back( index );
+            vertices.emplace_back( PROFILE[index] );
+        }
+    }
+
+    BenchResult makeResult( const char * name,
+                            size_t size,
+                            const char * side,
+                            unsigned precisionRatio,
+                            size_t cells )
+    {
+        BenchResult result{};
+        result.name = name;
+        result.width = size;
+        result.height = size;
+        result.side = side;
+        result.precisionCells = 1;
+        result.precisionRatio = precisionRatio;
+        result.cells = cells;
+        return result;
+    }
+
+    /**
+     * @brief measures all cases for square matrices of a given size
+     */
+    void benchSize( size_t size,
+                    const BenchSettings & SETTINGS,
+                    std::vector<BenchResult> & results )
+    {
+        //fixed seed keeps heights, and so the work done by every case, the same between runs
+        HeightMatrixGenerator generator( 1 );
+        const size_t CELLS = size * size;
+
+        //matrix construction including release of its storage
+        BenchResult construction = makeResult( "matrix_construction", size, "", 1, CELLS );
+        measure( [size]() {
+            HeightMatrix matrix( size, size, 1.0, HeightMatrix::MASTER );
+        }, SETTINGS, construction );
+        results.push_back(construction);
+
+        HeightMatrix matrix( size, size, 1.0, HeightMatrix::MASTER );
+        BenchResult filling = makeResult( "matrix_fill", size, "", 1, CELLS );
+        measure( [&matrix, &generator]() {
+            generator.fill(matrix);
+        }, SETTINGS, filling );
+        results.push_back(filling);
+
+        BenchResult singleThreadFilling = makeResult( "matrix_fill_single_thread", size, "", 1, CELLS );
+        measure( [&matrix, &generator]() {
+            generator.fill( matrix, 1 );
+        }, SETTINGS, singleThreadFilling );
+        results.push_back(singleThreadFilling);
+
+        //mesh built from scratch, as for a matrix of new dimensions
+        BenchResult layoutBuilding = makeResult( "mesh_matrix_grid_layout", size, "LEFT", 1, CELLS );
+        measure( [&matrix]() {
+            GridMesh mesh;
+            mesh.update( matrix, COMPARISON_SIDE::LEFT );
+        }, SETTINGS, layoutBuilding );
+        results.push_back(layoutBuilding);
+
+        //heights update with the layout already in place, every height changes as after regenerating a matrix of the same size
+        GridMesh mesh;
+        HeightMatrix regeneratedMatrix( size, size, 1.0, HeightMatrix::MASTER );
+        HeightMatrixGenerator( 2 ).fill(regeneratedMatrix);
+        bool useRegenerated = false;
+        BenchResult meshing = makeResult( "mesh_matrix_grid_heights", size, "LEFT", 1, CELLS );
+        measure( [&mesh, &matrix, &regeneratedMatrix, &useRegenerated]() {
+            mesh.update( useRegenerated ? regeneratedMatrix : matrix, COMPARISON_SIDE::LEFT );
+            useRegenerated = !useRegenerated;
+        }, SETTINGS, meshing );
+        results.push_back(meshing);
+        regeneratedMatrix = HeightMatrix( 0, 0, 1.0, HeightMatrix::MASTER );
+
+        for ( int sideIndex = 0; sideIndex < 4; sideIndex++ )
+        {
+            COMPARISON_SIDE side = HeightMatrix::sideFrom(sideIndex);
+            BenchResult comparison = makeResult( "mesh_comparison_side", size, SIDE_NAMES[sideIndex], 1, size );
+            measure( [&mesh, &matrix, side]() {
+                mesh.update( matrix, side, true );
+            }, SETTINGS, comparison );
+            results.push_back(comparison);
+        }
+        mesh = GridMesh();
+
+        //full coupling path of the arrangement widget, master covers the same extent with fewer and coarser cells
+        HeightMatrix & targetMatrix = matrix;
+        CouplingEngine engine;
+        std::vector<float> profilesVertices;
+        for ( unsigned ratio : PRECISION_RATIOS )
+        {
+            size_t masterSize = std::max( size / ratio, (size_t)2 );
+            HeightMatrix masterMatrix( masterSize, masterSize, (double)ratio, HeightMatrix::MASTER );
+            generator.fill(masterMatrix);
+            for ( int sideIndex = 0; sideIndex < 4; sideIndex++ )
+            {
+                COMPARISON_SIDE targetSide = HeightMatrix::sideFrom(sideIndex);
+                COMPARISON_SIDE masterSide = HeightMatrix::oppositeSide(targetSide);
+                BenchResult coupling = makeResult( "coupling", size, SIDE_NAMES[sideIndex], ratio, size );
+                measure( [&]() {
+                    engine.couple( masterMatrix, targetMatrix, masterSide, targetSide );
+                    const std::vector<float> & ORIGINAL_PROFILE = engine.getOriginalProfile();
+                    const std::vector<float> & ARRANGED_PROFILE = engine.getArrangedProfile();
+                    profilesVertices.clear();
+                    profilesVertices.reserve( ( ORIGINAL_PROFILE.size() + ARRANGED_PROFILE.size() ) * 2 );
+                    bufferProfileVertices( ORIGINAL_PROFILE, profilesVertices );
+                    bufferProfileVertices( ARRANGED_PROFILE, profilesVertices );
+                }, SETTINGS, coupling );
+                results.push_back(coupling);
+            }
+        }
+
+        //coupling with a fractional precision ratio through the polyphase resampler
+        size_t fractionalMasterSize = std::max( size * FRACTIONAL_RATIO_CELLS / FRACTIONAL_RATIO_STEPS, (size_t)2 );
+        HeightMatrix fractionalMasterMatrix( fractionalMasterSize, fractionalMasterSize,
+                                             (double)FRACTIONAL_RATIO_STEPS / FRACTIONAL_RATIO_CELLS, HeightMatrix::MASTER );
+        generator.fill(fractionalMasterMatrix);
+        for ( int sideIndex = 0; sideIndex < 4; sideIndex++ )
+        {
+            COMPARISON_SIDE targetSide = HeightMatrix::sideFrom(sideIndex);
+            COMPARISON_SIDE masterSide = HeightMatrix::oppositeSide(targetSide);
+            BenchResult coupling = makeResult( "coupling", size, SIDE_NAMES[sideIndex], FRACTIONAL_RATIO_STEPS, size );
+            coupling.precisionCells = FRACTIONAL_RATIO_CELLS;
+            measure( [&]() {
+                engine.couple( fractionalMasterMatrix, targetMatrix, masterSide, targetSide );
+            }, SETTINGS, coupling );
+            results.push_back(coupling);
+        }
+        fractionalMasterMatrix = HeightMatrix( 0, 0, 1.0, HeightMatrix::MASTER );
+
+        //whole matrix conversion to the coarser precision of the fractional ratio, cells count the result
+        PolyphaseResampler resampler;
+        const double RESAMPLED_PRECISION = (double)FRACTIONAL_RATIO_STEPS / FRACTIONAL_RATIO_CELLS;
+        resampler.setRatio( 1.0 / RESAMPLED_PRECISION );
+        const size_t RESAMPLED_SIZE = resampler.getResampledLength(size);
+        BenchResult resampling = makeResult( "matrix_resample", size, "", FRACTIONAL_RATIO_STEPS, RESAMPLED_SIZE * RESAMPLED_SIZE );
+        resampling.precisionCells = FRACTIONAL_RATIO_CELLS;
+        measure( [&]() {
+            HeightMatrix resampled = resampler.resampleMatrix( targetMatrix, RESAMPLED_PRECISION );
+        }, SETTINGS, resampling );
+        results.push_back(resampling);
+
+        //coupling with the correction spread over a blend zone, cells count the band
+        HeightMatrix blendMasterMatrix( size, size, 1.0, HeightMatrix::MASTER );
+        generator.fill(blendMasterMatrix);
+        CouplingEngine blendEngine;
+        blendEngine.setBlendZone(BLEND_WIDTH);
+        for ( int sideIndex = 0; sideIndex < 4; sideIndex++ )
+        {
+            COMPARISON_SIDE targetSide = HeightMatrix::sideFrom(sideIndex);
+            COMPARISON_SIDE masterSide = HeightMatrix::oppositeSide(targetSide);
+            BenchResult blend = makeResult( "coupling_blend", size, SIDE_NAMES[sideIndex], 1, size * std::min( BLEND_WIDTH, size ) );
+            measure( [&]() {
+                blendEngine.couple( blendMasterMatrix, targetMatrix, masterSide, targetSide );
+            }, SETTINGS, blend );
+            results.push_back(blend);
+        }
+    }
+
+    /**
+     * @brief writes results as a JSON document, throughput counts height values processed by a case
+     */
+    void writeJson( const std::vector<BenchResult> & RESULTS,
+                    FILE * output )
+    {
+        std::fprintf( output, "{\n  \"benchmarks\": [\n" );
+        for ( size_t index = 0; index < RESULTS.size(); index++ )
+        {
+            const BenchResult & RESULT = RESULTS[index];
+            double seconds = RESULT.nsPerIteration * 1e-9;
+            double cellsPerSecond = seconds > 0.0 ? RESULT.cells / seconds : 0.0;
+            std::fprintf( output,
+                          "    { \"name\": \"%s\", \"width\": %zu, \"height\": %zu, \"side\": \"%s\", \"precisionRatio\": \"%u:%u\", "
+                          "\"cells\": %zu, \"iterations\": %u, \"nsPerIteration\": %.1f, \"nsPerCell\": %.4f, "
+                          "\"bytesAllocated\": %llu, \"allocations\": %llu, \"cellsPerSecond\": %.1f, \"megabytesPerSecond\": %.2f }%s\n",
+                          RESULT.name.c_str(), RESULT.width, RESULT.height, RESULT.side.c_str(), RESULT.precisionCells, RESULT.precisionRatio,
+                          RESULT.cells, RESULT.iterations, RESULT.nsPerIteration, RESULT.nsPerIteration / RESULT.cells,
+                          (unsigned long long)RESULT.bytesAllocated, (unsigned long long)RESULT.allocations,
+                          cellsPerSecond, cellsPerSecond * sizeof(float) / ( 1024.0 * 1024.0 ),
+                          index + 1 < RESULTS.size() ? "," : "" );
+        }
+        std::fprintf( output, "  ]\n}\n" );
+    }
+
+    bool parseArguments( int argc,
+                         char * argv[],
+                         BenchSettings & settings )
+    {
+        for ( int index = 1; index < argc; index++ )
+        {
+            bool hasValue = index + 1 < argc;
+            if ( std::strcmp( argv[index], "--max-size" ) == 0 && hasValue )
+            {
+                settings.maxSize = std::strtoull( argv[++index], nullptr, 10 );
+            }
+            else if ( std::strcmp( argv[index], "--min-time-ms" ) == 0 && hasValue )
+            {
+                settings.minTimeSeconds = std::strtod( argv[++index], nullptr ) * 1e-3;
+            }
+            else if ( std::strcmp( argv[index], "--output" ) == 0 && hasValue )
+            {
+                settings.outputPath = argv[++index];
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main( int argc,
+          char * argv[] )
+{
+    BenchSettings settings;
+    if ( !parseArguments( argc, argv, settings ) )
+    {
+        std::fprintf( stderr, "usage: %s [--max-size N] [--min-time-ms T] [--output results.json]\n", argv[0] );
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    for ( size_t size : MATRIX_SIZES )
+    {
+        if ( size > settings.maxSize )
+        {
+            break;
+        }
+        std::fprintf( stderr, "benchmarking %zux%zu\n", size, size );
+        benchSize( size, settings, results );
+    }
+
+    FILE * output = settings.outputPath.empty() ? stdout : std::fopen( settings.outputPath.c_str(), "w" );
+    if ( output == nullptr )
+    {
+        std::fprintf( stderr, "unable to open %s\n", settings.outputPath.c_str() );
+        return 1;
+    }
+    writeJson( results, output );
+    if ( output != stdout )
+    {
+        std::fclose(output);
+    }
+    return 0;
+}
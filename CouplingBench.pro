@@ -0,0 +1,12 @@
+# Console benchmark of matrix, mesh and coupling hot paths, prints results as JSON
+
+TEMPLATE = app
+TARGET = CouplingBench
+CONFIG += console
+CONFIG -= qt app_bundle
+
+include(common.pri)
+include(CouplingEngine.pri)
+
+SOURCES += \
+        CouplingBench.cpp
@@ -0,0 +1,178 @@
+#include "CouplingEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "HeightMatrixFile.h"
+
+CouplingEngine::CouplingEngine()
+{}
+
+/**
+ * @brief updates target matrix line for a given side so that it matches the adjacent side of the master matrix
+ * @param MASTER_MATRIX master matrix
+ * @param targetMatrix target matrix
+ * @param masterSide side of the master matrix to couple with
+ * @param targetSide side of the target matrix to couple
+ * @return false if any of the matrices is empty or the target matrix is less precise than the master, true otherwise
+ */
+bool CouplingEngine::couple( const HeightMatrix & MASTER_MATRIX,
+                             HeightMatrix & targetMatrix,
+                             COMPARISON_SIDE masterSide,
+                             COMPARISON_SIDE targetSide )
+{
+    if ( MASTER_MATRIX.getWidth() == 0 || MASTER_MATRIX.getHeight() == 0 ||
+         targetMatrix.getWidth() == 0 || targetMatrix.getHeight() == 0 ||
+         MASTER_MATRIX.getPrecision() < targetMatrix.getPrecision() )
+    {
+        return false;
+    }
+
+    //first update original target line segment data
+    updateOriginalProfile( targetMatrix, targetSide );
+
+    //then arrange target line segment with adjacent segment of master line, which is read straight from the matrix cache
+    updateArrangedProfile( MASTER_MATRIX.getEdgeProfile(masterSide), MASTER_MATRIX.getPrecision(), targetMatrix.getPrecision() );
+
+    //renew target matrix comparison line
+    updateTargetMatrix( targetMatrix, targetSide );
+    return true;
+}
+
+/**
+ * @brief couples matrices stored in height matrix files without loading them.
+ * Only the master side and the target side are read and only the target side is written back,
+ * so I/O is proportional to the edge length rather than to the matrix area
+ * @param MASTER_PATH path to the master matrix file
+ * @param TARGET_PATH path to the target matrix file, modified in place
+ * @param masterSide side of the master matrix to couple with
+ * @param targetSide side of the target matrix to couple
+ * @return false if any of the files could not be read or written, is empty, or the target matrix is less precise than the master
+ */
+bool CouplingEngine::coupleFiles( const std::string & MASTER_PATH,
+                                  const std::string & TARGET_PATH,
+                                  COMPARISON_SIDE masterSide,
+                                  COMPARISON_SIDE targetSide )
+{
+    HeightMatrixFileHeader masterHeader;
+    HeightMatrixFileHeader targetHeader;
+    if ( !HeightMatrixFile::readEdge( MASTER_PATH, masterSide, masterHeader, masterProfile ) ||
+         !HeightMatrixFile::readEdge( TARGET_PATH, targetSide, targetHeader, originalProfile ) ||
+         masterHeader.precision < targetHeader.precision )
+    {
+        return false;
+    }
+    updateArrangedProfile( masterProfile, masterHeader.precision, targetHeader.precision );
+    return HeightMatrixFile::writeEdge( TARGET_PATH, targetSide, arrangedProfile );
+}
+
+/**
+ * @brief sets the band of target rows or columns the correction of the coupled side is spread over.
+ * Applies to couple() only, coupleFiles() writes the side alone
+ * @param width number of rows or columns including the side itself, 1 couples the side alone
+ * @param falloff shape of the correction falloff over the band
+ */
+void CouplingEngine::setBlendZone( size_t width,
+                                   EdgeBlender::FALLOFF falloff )
+{
+    blender.setWidth(width);
+    blender.setFalloff(falloff);
+}
+
+/**
+ * @brief cells of a target matrix couple() writes with the current blend zone: the side and the band behind it
+ * @param TARGET_MATRIX target matrix
+ * @param targetSide side of the target matrix to couple
+ * @return rectangle of the side and its band cut down to the matrix, empty for an empty matrix
+ */
+HeightMatrix::DirtyRect CouplingEngine::getCoupledRegion( const HeightMatrix & TARGET_MATRIX,
+                                                          COMPARISON_SIDE targetSide ) const
+{
+    const size_t WIDTH = TARGET_MATRIX.getWidth();
+    const size_t HEIGHT = TARGET_MATRIX.getHeight();
+    const size_t BAND = std::max( blender.getWidth(), (size_t)1 );
+    switch (targetSide)
+    {
+    case COMPARISON_SIDE::LEFT:
+        return HeightMatrix::DirtyRect{ 0, 0, std::min( BAND, WIDTH ), HEIGHT };
+    case COMPARISON_SIDE::RIGHT:
+        return HeightMatrix::DirtyRect{ WIDTH - std::min( BAND, WIDTH ), 0, std::min( BAND, WIDTH ), HEIGHT };
+    case COMPARISON_SIDE::TOP:
+        return HeightMatrix::DirtyRect{ 0, 0, WIDTH, std::min( BAND, HEIGHT ) };
+    default:
+        return HeightMatrix::DirtyRect{ 0, HEIGHT - std::min( BAND, HEIGHT ), WIDTH, std::min( BAND, HEIGHT ) };
+    }
+}
+
+/**
+ * @brief profile of the target side before the last coupling has been applied
+ */
+const std::vector<float> & CouplingEngine::getOriginalProfile() const
+{
+    return originalProfile;
+}
+
+/**
+ * @brief profile of the target side after the last coupling has been applied
+ */
+const std::vector<float> & CouplingEngine::getArrangedProfile() const
+{
+    return arrangedProfile;
+}
+
+/**
+ * @brief updates source profile data before coupling has been applied
+ * @param MATRIX matrix to take data from
+ * @param side side of the matrix
+ */
+void CouplingEngine::updateOriginalProfile( const HeightMatrix & MATRIX,
+                                            COMPARISON_SIDE side )
+{
+    const std::vector<float> & PROFILE = MATRIX.getEdgeProfile(side);
+    originalProfile.assign( PROFILE.begin(), PROFILE.end() );
+}
+
+/**
+ * @brief updates profile of the target line after coupling with corresponding master's line
+ * @param MASTER_PROFILE contiguous heights of the master side
+ * @param masterPrecision precision of the master matrix
+ * @param targetPrecision precision of the target matrix
+ * @note this function does nothing to target matrix itself, instead it fills arranged profile with master profile heights.
+ * Arranged profile always has the length of the original one: if the resampled master line is longer it is cut down,
+ * if it is shorter the rest is taken from the original profile
+ */
+void CouplingEngine::updateArrangedProfile( const std::vector<float> & MASTER_PROFILE,
+                                            double masterPrecision,
+                                            double targetPrecision )
+{
+    const double RATIO = masterPrecision / targetPrecision;
+    const double STEPS = std::round(RATIO);
+
+    arrangedProfile = originalProfile;
+    //integer ratios keep the specialized interpolation kernels, any other ratio goes through the polyphase filter bank
+    if ( STEPS >= 1.0 && std::abs( RATIO - STEPS ) <= 1e-9 * RATIO )
+    {
+        resampler.setSteps( (unsigned int)STEPS );
+        resampler.resample( MASTER_PROFILE.data(), MASTER_PROFILE.size(), arrangedProfile.data(), arrangedProfile.size() );
+    }
+    else
+    {
+        polyphaseResampler.setRatio(RATIO);
+        polyphaseResampler.resample( MASTER_PROFILE.data(), MASTER_PROFILE.size(), arrangedProfile.data(), arrangedProfile.size() );
+    }
+}
+
+/**
+ * @brief update target matrix line for a given side with values stored in arranged profile,
+ * then spreads the correction over the blend zone behind the line
+ * @param matrix matrix to update
+ * @param side side to update
+ */
+void CouplingEngine::updateTargetMatrix( HeightMatrix & matrix,
+                                         COMPARISON_SIDE side )
+{
+    HeightMatrix::LineView line = matrix.edge(side);
+    std::copy( arrangedProfile.begin(), arrangedProfile.end(), line.begin() );
+    blender.blend( matrix, side, originalProfile, arrangedProfile );
+    matrix.commitWrites();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "HeightMatrix.h"
+#include "EdgeBlender.h"
+#include "EdgeResampler.h"
+#include "PolyphaseResampler.h"
+
+/**
+ * @brief GUI-free coupling of a target matrix side with the adjacent side of a master matrix.
+ * Precisions may have any ratio, the master side is resampled onto the target cells.
+ * Keeps the original and arranged profiles of the last coupled target side, one height value per target cell.
+ * The correction of the side may be spread over a blend zone of the target interior, see EdgeBlender
+ */
+class CouplingEngine
+{
+public:
+    CouplingEngine();
+    bool couple( const HeightMatrix & MASTER_MATRIX,
+                 HeightMatrix & targetMatrix,
+                 COMPARISON_SIDE masterSide,
+                 COMPARISON_SIDE targetSide );
+    bool coupleFiles( const std::string & MASTER_PATH,
+                      const std::string & TARGET_PATH,
+                      COMPARISON_SIDE masterSide,
+                      COMPARISON_SIDE targetSide );
+    void setBlendZone( size_t width,
+                       EdgeBlender::FALLOFF falloff = EdgeBlender::SMOOTH );
+    HeightMatrix::DirtyRect getCoupledRegion( const HeightMatrix & TARGET_MATRIX,
+                                              COMPARISON_SIDE targetSide ) const;
+    const std::vector<float> & getOriginalProfile() const;
+    const std::vector<float> & getArrangedProfile() const;
+
+private:
+    void updateOriginalProfile( const HeightMatrix & MATRIX,
+                                COMPARISON_SIDE side );
+    void updateArrangedProfile( const std::vector<float> & MASTER_PROFILE,
+                                double masterPrecision,
+                                double targetPrecision );
+    void updateTargetMatrix( HeightMatrix & matrix,
+                             COMPARISON_SIDE side );
+
+private:
+    //master side read from a file, matrices provide their cached edge profiles instead
+    std::vector<float> masterProfile;
+    std::vector<float> originalProfile;
+    std::vector<float> arrangedProfile;
+    EdgeResampler resampler;
+    PolyphaseResampler polyphaseResampler;
+    EdgeBlender blender;
+};
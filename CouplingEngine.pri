@@ -0,0 +1,9 @@
+# Links a project against the GUI-free coupling engine static library built by CouplingEngine.pro
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+LIBS += -L$$OUT_PWD/lib -lCouplingEngine
+
+win32-msvc*: PRE_TARGETDEPS += $$OUT_PWD/lib/CouplingEngine.lib
+else: PRE_TARGETDEPS += $$OUT_PWD/lib/libCouplingEngine.a
@@ -0,0 +1,42 @@
+# GUI-free static library with height matrix storage, coupling math and grid mesh building, usable from batch jobs without OpenGL
+
+TEMPLATE = lib
+TARGET = CouplingEngine
+CONFIG += staticlib
+CONFIG -= qt
+DESTDIR = $$OUT_PWD/lib
+
+include(common.pri)
+
+SOURCES += \
+        CouplingEngine.cpp \
+        CouplingHistory.cpp \
+        CpuFeatures.cpp \
+        EdgeBlender.cpp \
+        EdgeResampler.cpp \
+        GridMesh.cpp \
+        HeightMatrix.cpp \
+        HeightMatrixFile.cpp \
+        HeightMatrixGenerator.cpp \
+        MappedFile.cpp \
+        MosaicCoupler.cpp \
+        PolyphaseResampler.cpp \
+        SceneMesh.cpp
+
+HEADERS += \
+    AlignedAllocator.h \
+    CouplingEngine.h \
+    CouplingHistory.h \
+    CpuFeatures.h \
+    EdgeBlender.h \
+    EdgeResampler.h \
+    GridMesh.h \
+    HeightMatrix.h \
+    HeightMatrixFile.h \
+    HeightMatrixGenerator.h \
+    MappedFile.h \
+    MatrixLine.h \
+    MosaicCoupler.h \
+    ParallelFor.h \
+    PolyphaseResampler.h \
+    SceneMesh.h
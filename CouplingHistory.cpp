@@ -0,0 +1,195 @@
+#include "CouplingHistory.h"
+
+#include <algorithm>
+
+CouplingHistory::CouplingHistory( size_t maxBytes )
+    : appliedCount(0)
+    , bytes(0)
+    , maxBytes(maxBytes)
+{}
+
+/**
+ * @brief couples matrices with a given engine and records the cells the coupling wrote as a new step.
+ * Undone steps are discarded
+ * @param engine engine with the coupling parameters to apply
+ * @param MASTER_MATRIX master matrix
+ * @param targetMatrix target matrix
+ * @param masterSide side of the master matrix to couple with
+ * @param targetSide side of the target matrix to couple
+ * @return false if the engine refused to couple the matrices, nothing is recorded then
+ */
+bool CouplingHistory::couple( CouplingEngine & engine,
+                              const HeightMatrix & MASTER_MATRIX,
+                              HeightMatrix & targetMatrix,
+                              COMPARISON_SIDE masterSide,
+                              COMPARISON_SIDE targetSide )
+{
+    Step step;
+    step.region = engine.getCoupledRegion( targetMatrix, targetSide );
+    step.matrixWidth = targetMatrix.getWidth();
+    step.matrixHeight = targetMatrix.getHeight();
+    readRegion( targetMatrix, step.region, step.before );
+    if ( !engine.couple( MASTER_MATRIX, targetMatrix, masterSide, targetSide ) )
+    {
+        return false;
+    }
+    readRegion( targetMatrix, step.region, step.after );
+
+    while ( steps.size() > appliedCount )
+    {
+        bytes -= getStepBytes( steps.back() );
+        steps.pop_back();
+    }
+    bytes += getStepBytes(step);
+    steps.push_back( std::move(step) );
+    appliedCount++;
+    trim();
+    return true;
+}
+
+/**
+ * @brief restores the cells written by the last applied coupling, only those cells become dirty
+ * @param targetMatrix matrix the step was recorded on
+ * @return false if there is nothing to undo or the matrix dimensions differ from the recorded ones
+ */
+bool CouplingHistory::undo( HeightMatrix & targetMatrix )
+{
+    if ( !canUndo() || !writeRegion( targetMatrix, steps[appliedCount - 1], steps[appliedCount - 1].before ) )
+    {
+        return false;
+    }
+    appliedCount--;
+    return true;
+}
+
+/**
+ * @brief applies the last undone coupling again without recomputing it, only the cells it wrote become dirty
+ * @param targetMatrix matrix the step was recorded on
+ * @return false if there is nothing to redo or the matrix dimensions differ from the recorded ones
+ */
+bool CouplingHistory::redo( HeightMatrix & targetMatrix )
+{
+    if ( !canRedo() || !writeRegion( targetMatrix, steps[appliedCount], steps[appliedCount].after ) )
+    {
+        return false;
+    }
+    appliedCount++;
+    return true;
+}
+
+bool CouplingHistory::canUndo() const
+{
+    return appliedCount > 0;
+}
+
+bool CouplingHistory::canRedo() const
+{
+    return appliedCount < steps.size();
+}
+
+/**
+ * @brief forgets all steps, e.g. after the target matrix has been replaced
+ */
+void CouplingHistory::clear()
+{
+    steps.clear();
+    appliedCount = 0;
+    bytes = 0;
+}
+
+/**
+ * @brief sets the memory limit of the recorded values, oldest steps are dropped right away if it is exceeded
+ * @param maxBytes limit in bytes, a step larger than that is not kept at all
+ */
+void CouplingHistory::setMaxBytes( size_t maxBytes )
+{
+    this->maxBytes = maxBytes;
+    trim();
+}
+
+size_t CouplingHistory::getMaxBytes() const
+{
+    return maxBytes;
+}
+
+/**
+ * @brief memory taken by the recorded values of all steps
+ */
+size_t CouplingHistory::getBytes() const
+{
+    return bytes;
+}
+
+/**
+ * @brief copies values of a matrix region row by row
+ * @param MATRIX matrix to read
+ * @param REGION region within the matrix
+ * @param values storage resized to the region
+ */
+void CouplingHistory::readRegion( const HeightMatrix & MATRIX,
+                                  const HeightMatrix::DirtyRect & REGION,
+                                  std::vector<float> & values )
+{
+    values.resize( REGION.width * REGION.height );
+    float * value = values.data();
+    for ( size_t rowIndex = REGION.row; rowIndex < REGION.row + REGION.height; rowIndex++ )
+    {
+        HeightMatrix::ConstLineView row = MATRIX.row(rowIndex);
+        value = std::copy( row.begin() + REGION.column, row.begin() + REGION.column + REGION.width, value );
+    }
+}
+
+/**
+ * @brief writes recorded values back to the region of a step, the region is marked dirty
+ * @param matrix matrix the step was recorded on
+ * @param STEP step whose region to write
+ * @param VALUES values of the region row by row
+ * @return false if the matrix dimensions differ from the recorded ones
+ */
+bool CouplingHistory::writeRegion( HeightMatrix & matrix,
+                                   const Step & STEP,
+                                   const std::vector<float> & VALUES )
+{
+    if ( matrix.getWidth() != STEP.matrixWidth || matrix.getHeight() != STEP.matrixHeight )
+    {
+        return false;
+    }
+    const HeightMatrix::DirtyRect & REGION = STEP.region;
+    const size_t STRIDE = matrix.getStride();
+    float * values = matrix.data(REGION);
+    const float * value = VALUES.data();
+    for ( size_t rowIndex = REGION.row; rowIndex < REGION.row + REGION.height; rowIndex++ )
+    {
+        std::copy( value, value + REGION.width, values + rowIndex * STRIDE + REGION.column );
+        value += REGION.width;
+    }
+    matrix.commitWrites();
+    return true;
+}
+
+size_t CouplingHistory::getStepBytes( const Step & STEP )
+{
+    return ( STEP.before.size() + STEP.after.size() ) * sizeof(float);
+}
+
+/**
+ * @brief drops steps until the recorded values fit the memory limit: the oldest applied steps first,
+ * then undone steps from the last one, so that the remaining steps still follow each other
+ */
+void CouplingHistory::trim()
+{
+    while ( bytes > maxBytes && !steps.empty() )
+    {
+        if ( appliedCount > 0 )
+        {
+            bytes -= getStepBytes( steps.front() );
+            steps.pop_front();
+            appliedCount--;
+        }
+        else
+        {
+            bytes -= getStepBytes( steps.back() );
+            steps.pop_back();
+        }
+    }
+}
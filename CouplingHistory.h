@@ -0,0 +1,66 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "CouplingEngine.h"
+#include "HeightMatrix.h"
+
+/**
+ * @brief Undo and redo history of the couplings of a target matrix.
+ * Every step keeps only the cells its coupling wrote, the coupled side and its blend band, as they were before and after,
+ * so both the memory of a step and the time to undo or redo it are proportional to the side length times the band width
+ * rather than to the matrix area. Coupling after an undo discards the undone steps, so coupling parameters can be tried out
+ * one after another on the same matrix. Oldest steps are dropped once the history exceeds its memory limit
+ * @note steps are bound to the matrix they were recorded on, the history has to be cleared when the target matrix is replaced
+ */
+class CouplingHistory
+{
+public:
+    //memory limit of the recorded values unless set otherwise
+    constexpr static size_t DEFAULT_MAX_BYTES = 256 * 1024 * 1024;
+
+    explicit CouplingHistory( size_t maxBytes = DEFAULT_MAX_BYTES );
+    bool couple( CouplingEngine & engine,
+                 const HeightMatrix & MASTER_MATRIX,
+                 HeightMatrix & targetMatrix,
+                 COMPARISON_SIDE masterSide,
+                 COMPARISON_SIDE targetSide );
+    bool undo( HeightMatrix & targetMatrix );
+    bool redo( HeightMatrix & targetMatrix );
+    bool canUndo() const;
+    bool canRedo() const;
+    void clear();
+    void setMaxBytes( size_t maxBytes );
+    size_t getMaxBytes() const;
+    size_t getBytes() const;
+
+private:
+    /**
+     * @brief Cells written by one coupling, values are stored row by row
+     */
+    struct Step
+    {
+        HeightMatrix::DirtyRect region;
+        size_t matrixWidth;
+        size_t matrixHeight;
+        std::vector<float> before;
+        std::vector<float> after;
+    };
+
+    static void readRegion( const HeightMatrix & MATRIX,
+                            const HeightMatrix::DirtyRect & REGION,
+                            std::vector<float> & values );
+    static bool writeRegion( HeightMatrix & matrix,
+                             const Step & STEP,
+                             const std::vector<float> & VALUES );
+    static size_t getStepBytes( const Step & STEP );
+    void trim();
+
+private:
+    std::deque<Step> steps;
+    //steps before this one are applied to the matrix, the rest have been undone
+    size_t appliedCount;
+    size_t bytes;
+    size_t maxBytes;
+};
@@ -0,0 +1,173 @@
+#include <QCommandLineParser>
+#include <QGuiApplication>
+#include <QStringList>
+
+#include "HeightMatrixFile.h"
+#include "OffscreenRenderer.h"
+
+namespace
+{
+    bool parseSide( const QString & NAME,
+                    COMPARISON_SIDE & side )
+    {
+        const QString LOWER_NAME = NAME.toLower();
+        if ( LOWER_NAME == "left" )
+        {
+            side = COMPARISON_SIDE::LEFT;
+        }
+        else if ( LOWER_NAME == "right" )
+        {
+            side = COMPARISON_SIDE::RIGHT;
+        }
+        else if ( LOWER_NAME == "top" )
+        {
+            side = COMPARISON_SIDE::TOP;
+        }
+        else if ( LOWER_NAME == "bottom" )
+        {
+            side = COMPARISON_SIDE::BOTTOM;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    bool parseSize( const QString & VALUE,
+                    int & width,
+                    int & height )
+    {
+        const QStringList PARTS = VALUE.split('x');
+        bool widthValid = false;
+        bool heightValid = false;
+        if ( PARTS.size() == 2 )
+        {
+            width = PARTS[0].toInt(&widthValid);
+            height = PARTS[1].toInt(&heightValid);
+        }
+        return widthValid && heightValid && width > 0 && height > 0;
+    }
+
+    bool parseEyePosition( const QString & VALUE,
+                           QVector3D & eyePosition )
+    {
+        const QStringList PARTS = VALUE.split(',');
+        if ( PARTS.size() != 3 )
+        {
+            return false;
+        }
+        bool valid[3] = { false, false, false };
+        eyePosition = QVector3D( PARTS[0].toFloat( &valid[0] ), PARTS[1].toFloat( &valid[1] ), PARTS[2].toFloat( &valid[2] ) );
+        return valid[0] && valid[1] && valid[2];
+    }
+
+    bool mapMatrix( const QString & PATH,
+                    MappedFile::MAPPING_MODE mode,
+                    HeightMatrix & matrix )
+    {
+        if ( !HeightMatrixFile::map( PATH.toStdString(), mode, matrix ) )
+        {
+            qWarning( "Unable to read height matrix file %s", qPrintable(PATH) );
+            return false;
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief renders a matrix, profiles or arrangement view of height matrix files to a PNG image without a window.
+ * Runs with the offscreen platform plugin, so no display is needed: QT_QPA_PLATFORM=offscreen
+ */
+int main( int argc,
+          char * argv[] )
+{
+    QGuiApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Renders views of height matrix files to PNG images without a window" );
+    parser.addHelpOption();
+    parser.addPositionalArgument( "master", "Height matrix file, the only one needed by the matrix view" );
+    parser.addPositionalArgument( "target", "Target height matrix file for the profiles and arrangement views", "[target]" );
+    QCommandLineOption viewOption( "view", "View to render: matrix, profiles or arrangement", "view", "matrix" );
+    QCommandLineOption sideOption( "side", "Side of the master matrix: left, right, top or bottom", "side", "right" );
+    QCommandLineOption targetSideOption( "target-side", "Side of the target matrix, opposite to the master side by default", "side" );
+    QCommandLineOption sizeOption( "size", "Image size", "WxH", "512x512" );
+    QCommandLineOption eyeOption( "eye", "Camera position of the matrix view, fitted to the matrix by default", "x,y,z" );
+    QCommandLineOption heightTextureOption( "height-texture", "Render matrix mesh from the height texture" );
+    QCommandLineOption flatGridOption( "flat-grid", "Render flat grid layer" );
+    QCommandLineOption outputOption( QStringList() << "o" << "output", "Output PNG file", "file" );
+    parser.addOptions( { viewOption, sideOption, targetSideOption, sizeOption, eyeOption, heightTextureOption, flatGridOption, outputOption } );
+    parser.process(application);
+
+    const QStringList POSITIONAL = parser.positionalArguments();
+    const QString VIEW = parser.value(viewOption);
+    COMPARISON_SIDE masterSide;
+    int width = 0;
+    int height = 0;
+    if ( POSITIONAL.isEmpty() || !parser.isSet(outputOption) ||
+         ( VIEW != "matrix" && POSITIONAL.size() < 2 ) ||
+         ( VIEW != "matrix" && VIEW != "profiles" && VIEW != "arrangement" ) ||
+         !parseSide( parser.value(sideOption), masterSide ) ||
+         !parseSize( parser.value(sizeOption), width, height ) )
+    {
+        parser.showHelp(1);
+    }
+    COMPARISON_SIDE targetSide = HeightMatrix::oppositeSide(masterSide);
+    if ( parser.isSet(targetSideOption) && !parseSide( parser.value(targetSideOption), targetSide ) )
+    {
+        parser.showHelp(1);
+    }
+
+    OffscreenRenderer renderer( width, height );
+    if ( !renderer.isValid() )
+    {
+        return 1;
+    }
+    HeightMatrix masterMatrix( 0, 0, 1.0, HeightMatrix::MASTER );
+    if ( !mapMatrix( POSITIONAL[0], MappedFile::READ_ONLY, masterMatrix ) )
+    {
+        return 1;
+    }
+
+    QImage image;
+    if ( VIEW == "matrix" )
+    {
+        QVector3D eyePosition;
+        if ( parser.isSet(eyeOption) )
+        {
+            if ( !parseEyePosition( parser.value(eyeOption), eyePosition ) )
+            {
+                parser.showHelp(1);
+            }
+            renderer.setEyePosition(eyePosition);
+        }
+        else
+        {
+            renderer.fitEyePosition(masterMatrix);
+        }
+        image = renderer.renderMatrix( masterMatrix, masterSide, parser.isSet(heightTextureOption), parser.isSet(flatGridOption) );
+    }
+    else
+    {
+        //arrangement couples the target, pages it writes stay private so the file is never modified
+        HeightMatrix targetMatrix( 0, 0, 1.0, HeightMatrix::TARGET );
+        if ( !mapMatrix( POSITIONAL[1], MappedFile::COPY_ON_WRITE, targetMatrix ) )
+        {
+            return 1;
+        }
+        image = ( VIEW == "profiles" ) ? renderer.renderProfiles( masterMatrix, targetMatrix, masterSide, targetSide )
+                                       : renderer.renderArrangement( masterMatrix, targetMatrix, masterSide, targetSide );
+    }
+
+    if ( image.isNull() )
+    {
+        qWarning( "Nothing was rendered, matrices may not be coupled with the given sides" );
+        return 1;
+    }
+    if ( !image.save( parser.value(outputOption), "PNG" ) )
+    {
+        qWarning( "Unable to save image to %s", qPrintable( parser.value(outputOption) ) );
+        return 1;
+    }
+    return 0;
+}
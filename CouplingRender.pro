@@ -0,0 +1,34 @@
+# Console renderer of matrix, profiles and arrangement views to PNG images, needs no window or display
+
+QT += core gui opengl
+
+TARGET = CouplingRender
+CONFIG += console
+CONFIG -= app_bundle
+
+include(common.pri)
+include(CouplingEngine.pri)
+
+SOURCES += \
+        CameraBlock.cpp \
+        CoordinateSystem.cpp \
+        CouplingRender.cpp \
+        FrameProfiler.cpp \
+        Grid.cpp \
+        OffscreenRenderer.cpp \
+        ShaderProgramCache.cpp \
+        StreamingBuffer.cpp \
+        UniformLocationCache.cpp
+
+HEADERS += \
+    CameraBlock.h \
+    CoordinateSystem.h \
+    FrameProfiler.h \
+    Grid.h \
+    OffscreenRenderer.h \
+    ShaderProgramCache.h \
+    StreamingBuffer.h \
+    UniformLocationCache.h
+
+RESOURCES += \
+    Shaders.qrc
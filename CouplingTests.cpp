@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "CouplingEngine.h"
+#include "GridMesh.h"
+#include "HeightMatrix.h"
+#include "HeightMatrixGenerator.h"
+#include "ParallelFor.h"
+
+//----checks---------
+//every failed check is reported with its description, the process exits with 1 if any check failed
+
+namespace
+{
+    int failedChecks = 0;
+
+    void check( bool condition,
+                const char * DESCRIPTION )
+    {
+        if ( !condition )
+        {
+            std::fprintf( stderr, "FAILED: %s\n", DESCRIPTION );
+            failedChecks++;
+        }
+    }
+
+    const char * sideName( COMPARISON_SIDE side )
+    {
+        static const char * const NAMES[] = { "left", "right", "top", "bottom" };
+        return NAMES[(size_t)side];
+    }
+
+    /**
+     * @brief height of a cell at a given depth from a side along a given line across the side
+     */
+    float cellAtDepth( const HeightMatrix & MATRIX,
+                       COMPARISON_SIDE side,
+                       size_t line,
+                       size_t depth )
+    {
+        switch (side)
+        {
+        case COMPARISON_SIDE::LEFT:
+            return MATRIX.row(line)[depth];
+        case COMPARISON_SIDE::RIGHT:
+            return MATRIX.row(line)[MATRIX.getWidth() - 1 - depth];
+        case COMPARISON_SIDE::TOP:
+            return MATRIX.row(depth)[line];
+        default:
+            return MATRIX.row( MATRIX.getHeight() - 1 - depth )[line];
+        }
+    }
+
+    //----tests---------
+
+    /**
+     * @brief a blend band wider than the matrix falls to 0 at the opposite edge instead of stopping at a high weight next to it
+     */
+    void testBlendBandWiderThanMatrix()
+    {
+        const size_t SIZE = 10;
+        const size_t BAND = 64;
+        for ( EdgeBlender::FALLOFF falloff : { EdgeBlender::LINEAR, EdgeBlender::SMOOTH } )
+        {
+            for ( int sideIndex = 0; sideIndex < 4; sideIndex++ )
+            {
+                COMPARISON_SIDE targetSide = HeightMatrix::sideFrom(sideIndex);
+                HeightMatrix master( SIZE, SIZE, 1.0, HeightMatrix::MASTER );
+                HeightMatrix target( SIZE, SIZE, 1.0, HeightMatrix::TARGET );
+                HeightMatrixGenerator( 1 + sideIndex ).fill(master);
+                HeightMatrixGenerator( 101 + sideIndex ).fill(target);
+                const HeightMatrix ORIGINAL(target);
+
+                CouplingEngine engine;
+                engine.setBlendZone( BAND, falloff );
+                check( engine.couple( master, target, HeightMatrix::oppositeSide(targetSide), targetSide ), "blend coupling succeeds" );
+
+                bool oppositeEdgeKept = true;
+                bool tapered = true;
+                for ( size_t line = 0; line < SIZE; line++ )
+                {
+                    const float CORRECTION = cellAtDepth( target, targetSide, line, 0 ) - cellAtDepth( ORIGINAL, targetSide, line, 0 );
+                    oppositeEdgeKept &= cellAtDepth( target, targetSide, line, SIZE - 1 ) == cellAtDepth( ORIGINAL, targetSide, line, SIZE - 1 );
+                    for ( size_t depth = 1; depth < SIZE - 1; depth++ )
+                    {
+                        const float DELTA = cellAtDepth( target, targetSide, line, depth ) - cellAtDepth( ORIGINAL, targetSide, line, depth );
+                        //weights reach 0 at the opposite edge, SIZE - 1 cells away from the coupled one
+                        const float DISTANCE = (float)depth / ( SIZE - 1 );
+                        const float WEIGHT = falloff == EdgeBlender::LINEAR ? 1.0f - DISTANCE
+                                                                            : 1.0f - DISTANCE * DISTANCE * ( 3.0f - 2.0f * DISTANCE );
+                        tapered &= std::fabs( DELTA - CORRECTION * WEIGHT ) <= 1e-5f;
+                    }
+                }
+                if ( !oppositeEdgeKept || !tapered )
+                {
+                    std::fprintf( stderr, "  %s side, %s falloff\n", sideName(targetSide), falloff == EdgeBlender::LINEAR ? "linear" : "smooth" );
+                }
+                check( oppositeEdgeKept, "band wider than the matrix keeps the opposite edge" );
+                check( tapered, "band wider than the matrix tapers to 0 at the opposite edge" );
+            }
+        }
+    }
+
+    /**
+     * @brief heights written through a mutable view kept across getEdgeProfile() show up in the next profile
+     */
+    void testEdgeProfileSeesWritesThroughKeptView()
+    {
+        HeightMatrix matrix( 8, 6, 1.0, HeightMatrix::TARGET );
+        HeightMatrixGenerator(7).fill(matrix);
+
+        HeightMatrix::LineView edge = matrix.edge(COMPARISON_SIDE::LEFT);
+        HeightMatrix::LineView row = matrix.row(5);
+        matrix.getEdgeProfile(COMPARISON_SIDE::LEFT);
+        matrix.getEdgeProfile(COMPARISON_SIDE::BOTTOM);
+        edge[0] = 1.5f;
+        row[3] = 0.25f;
+        check( matrix.getEdgeProfile(COMPARISON_SIDE::LEFT)[0] == 1.5f, "edge view write after getEdgeProfile is seen" );
+        check( matrix.getEdgeProfile(COMPARISON_SIDE::BOTTOM)[3] == 0.25f, "row view write after getEdgeProfile is seen" );
+
+        //committed writes are cached, a new view opens the edge again
+        matrix.commitWrites();
+        check( matrix.getEdgeProfile(COMPARISON_SIDE::LEFT)[0] == 1.5f, "committed profile is up to date" );
+        matrix.column(0)[0] = 0.5f;
+        check( matrix.getEdgeProfile(COMPARISON_SIDE::LEFT)[0] == 0.5f, "new view invalidates the committed profile" );
+    }
+
+    /**
+     * @brief concurrent const readers of one committed matrix all get its edge profiles
+     */
+    void testEdgeProfileConcurrentReaders()
+    {
+        const size_t SIZE = 257;
+        HeightMatrix matrix( SIZE, SIZE, 1.0, HeightMatrix::MASTER );
+        HeightMatrixGenerator(11).fill(matrix);
+        const HeightMatrix & MATRIX = matrix;
+
+        const size_t READS = 64;
+        std::vector<char> matches( READS, 0 );
+        parallelFor( READS, [&]( size_t read ) {
+            COMPARISON_SIDE side = HeightMatrix::sideFrom( (int)( read % 4 ) );
+            const std::vector<float> & PROFILE = MATRIX.getEdgeProfile(side);
+            HeightMatrix::ConstLineView line = MATRIX.edge(side);
+            matches[read] = PROFILE.size() == SIZE && std::equal( line.begin(), line.end(), PROFILE.begin() );
+        } );
+        check( std::count( matches.begin(), matches.end(), 1 ) == (long)READS, "concurrent readers get the edge profiles" );
+    }
+
+    /**
+     * @brief a grid mesh given another matrix of the same size reads all of its heights, not only its dirty rectangles
+     */
+    void testGridMeshOtherMatrixOfSameSize()
+    {
+        HeightMatrix first( 100, 70, 1.0, HeightMatrix::MASTER );
+        HeightMatrix second( 100, 70, 1.0, HeightMatrix::MASTER );
+        HeightMatrixGenerator(3).fill(first);
+        HeightMatrixGenerator(4).fill(second);
+        second.clearDirtyRects();
+
+        GridMesh mesh;
+        mesh.update( first, COMPARISON_SIDE::LEFT );
+        first.clearDirtyRects();
+        mesh.update( second, COMPARISON_SIDE::LEFT );
+        GridMesh reference;
+        reference.update( second, COMPARISON_SIDE::LEFT );
+        check( mesh.getHeights() == reference.getHeights(), "other matrix of the same size replaces all heights" );
+        check( !mesh.getChangedHeights().empty(), "other matrix of the same size reports changed heights" );
+
+        //a moved matrix keeps its id, so only its dirty rectangles are read again
+        HeightMatrix moved( std::move(second) );
+        moved.row(10)[20] = 1.75f;
+        mesh.update( moved, COMPARISON_SIDE::LEFT );
+        reference.update( moved, COMPARISON_SIDE::LEFT );
+        check( mesh.getHeights() == reference.getHeights(), "moved matrix refreshes its dirty rectangles" );
+    }
+}
+
+/**
+ * @brief runs the engine checks, returns 1 if any of them failed
+ */
+int main()
+{
+    testBlendBandWiderThanMatrix();
+    testEdgeProfileSeesWritesThroughKeptView();
+    testEdgeProfileConcurrentReaders();
+    testGridMeshOtherMatrixOfSameSize();
+
+    if ( failedChecks != 0 )
+    {
+        std::fprintf( stderr, "%d checks failed\n", failedChecks );
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,12 @@
+# Console checks of the coupling engine, exits with 1 if any check failed
+
+TEMPLATE = app
+TARGET = CouplingTests
+CONFIG += console
+CONFIG -= qt app_bundle
+
+include(common.pri)
+include(CouplingEngine.pri)
+
+SOURCES += \
+        CouplingTests.cpp
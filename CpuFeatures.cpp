@@ -0,0 +1,64 @@
+#include "CpuFeatures.h"
+
+#if defined(COUPLING_X86_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+#if defined(COUPLING_X86_SIMD) && defined(_MSC_VER)
+    /**
+     * @brief checks CPUID feature bit of a given leaf
+     * @param leaf CPUID leaf
+     * @param registerIndex index of the result register (0 - EAX, 1 - EBX, 2 - ECX, 3 - EDX)
+     * @param bit bit to test
+     */
+    bool cpuidBit( int leaf,
+                   int registerIndex,
+                   int bit )
+    {
+        int registers[4];
+        __cpuid( registers, 0 );
+        if ( registers[0] < leaf )
+        {
+            return false;
+        }
+        __cpuidex( registers, leaf, 0 );
+        return ( registers[registerIndex] >> bit ) & 1;
+    }
+#endif
+}
+
+/**
+ * @brief whether SSE2 instructions may be used
+ */
+bool CpuFeatures::hasSse2()
+{
+#if !defined(COUPLING_X86_SIMD)
+    return false;
+#elif defined(_MSC_VER)
+    return cpuidBit( 1, 3, 26 );
+#else
+    static const bool SUPPORTED = __builtin_cpu_supports("sse2");
+    return SUPPORTED;
+#endif
+}
+
+/**
+ * @brief whether AVX2 instructions may be used, including OS support of the upper YMM state
+ */
+bool CpuFeatures::hasAvx2()
+{
+#if !defined(COUPLING_X86_SIMD)
+    return false;
+#elif defined(_MSC_VER)
+    static const bool SUPPORTED = cpuidBit( 1, 2, 27 )              //OSXSAVE
+                                  && ( _xgetbv(0) & 0x6 ) == 0x6    //XMM and YMM state enabled by OS
+                                  && cpuidBit( 7, 1, 5 );           //AVX2
+    return SUPPORTED;
+#else
+    static const bool SUPPORTED = __builtin_cpu_supports("avx2");
+    return SUPPORTED;
+#endif
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+//x86 SIMD kernels are compiled in only for x86 targets, other architectures use scalar code paths
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define COUPLING_X86_SIMD 1
+#endif
+
+//kernels for instruction sets above the build baseline are compiled per function and picked at runtime
+#if defined(__GNUC__) || defined(__clang__)
+#define COUPLING_TARGET_SSE2 __attribute__((target("sse2")))
+#define COUPLING_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define COUPLING_TARGET_SSE2
+#define COUPLING_TARGET_AVX2
+#endif
+
+/**
+ * @brief Runtime detection of the SIMD instruction sets available on the current CPU
+ */
+class CpuFeatures
+{
+public:
+    static bool hasSse2();
+    static bool hasAvx2();
+};
@@ -0,0 +1,227 @@
+#include "EdgeBlender.h"
+
+#include <algorithm>
+
+#include "CpuFeatures.h"
+
+#ifdef COUPLING_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    void addScaledScalar( float * line,
+                          const float * VALUES,
+                          float scale,
+                          size_t length )
+    {
+        for ( size_t index = 0; index < length; index++ )
+        {
+            line[index] += VALUES[index] * scale;
+        }
+    }
+
+#ifdef COUPLING_X86_SIMD
+    COUPLING_TARGET_SSE2
+    void addScaledSse2( float * line,
+                        const float * VALUES,
+                        float scale,
+                        size_t length )
+    {
+        const __m128 SCALE = _mm_set1_ps(scale);
+        size_t index = 0;
+        for ( ; index + 4 <= length; index += 4 )
+        {
+            __m128 sum = _mm_add_ps( _mm_loadu_ps( line + index ), _mm_mul_ps( _mm_loadu_ps( VALUES + index ), SCALE ) );
+            _mm_storeu_ps( line + index, sum );
+        }
+        addScaledScalar( line + index, VALUES + index, scale, length - index );
+    }
+
+    COUPLING_TARGET_AVX2
+    void addScaledAvx2( float * line,
+                        const float * VALUES,
+                        float scale,
+                        size_t length )
+    {
+        const __m256 SCALE = _mm256_set1_ps(scale);
+        size_t index = 0;
+        for ( ; index + 8 <= length; index += 8 )
+        {
+            __m256 sum = _mm256_add_ps( _mm256_loadu_ps( line + index ), _mm256_mul_ps( _mm256_loadu_ps( VALUES + index ), SCALE ) );
+            _mm256_storeu_ps( line + index, sum );
+        }
+        //upper halves are cleared, legacy SSE code running with them dirty stalls on every call
+        _mm256_zeroupper();
+        addScaledSse2( line + index, VALUES + index, scale, length - index );
+    }
+#endif
+}
+
+/**
+ * @param width number of rows or columns of the band including the edge, 1 leaves the interior untouched
+ * @param falloff shape of the weights over the band
+ */
+EdgeBlender::EdgeBlender( size_t width,
+                          FALLOFF falloff )
+    : width(0)
+    , falloff(falloff)
+    , weightsSpan(0)
+    , kernel( selectKernel() )
+{
+    setWidth(width);
+}
+
+/**
+ * @brief sets band width, weights are rebuilt by the next blend when the value changes
+ * @param width number of rows or columns of the band including the edge, at least one
+ */
+void EdgeBlender::setWidth( size_t width )
+{
+    width = std::max( (size_t)1, width );
+    if ( width == this->width )
+    {
+        return;
+    }
+    this->width = width;
+    weightsSpan = 0;
+}
+
+size_t EdgeBlender::getWidth() const
+{
+    return width;
+}
+
+void EdgeBlender::setFalloff( FALLOFF falloff )
+{
+    if ( falloff == this->falloff )
+    {
+        return;
+    }
+    this->falloff = falloff;
+    weightsSpan = 0;
+}
+
+EdgeBlender::FALLOFF EdgeBlender::getFalloff() const
+{
+    return falloff;
+}
+
+/**
+ * @brief adds the scaled edge correction to the band cells behind the edge, the edge itself has to be written by the caller.
+ * A band as wide as the matrix or wider is cut down so that the weights fall to 0 at the opposite edge, which keeps its heights
+ * @param matrix matrix whose edge has been coupled
+ * @param side coupled side of the matrix
+ * @param ORIGINAL_PROFILE edge heights before coupling
+ * @param ARRANGED_PROFILE edge heights after coupling, of the same length
+ */
+void EdgeBlender::blend( HeightMatrix & matrix,
+                         COMPARISON_SIDE side,
+                         const std::vector<float> & ORIGINAL_PROFILE,
+                         const std::vector<float> & ARRANGED_PROFILE )
+{
+    const size_t MATRIX_WIDTH = matrix.getWidth();
+    const size_t MATRIX_HEIGHT = matrix.getHeight();
+    const bool HORIZONTAL_EDGE = side == COMPARISON_SIDE::TOP || side == COMPARISON_SIDE::BOTTOM;
+    const size_t EDGE_LENGTH = HORIZONTAL_EDGE ? MATRIX_WIDTH : MATRIX_HEIGHT;
+    const size_t EXTENT = HORIZONTAL_EDGE ? MATRIX_HEIGHT : MATRIX_WIDTH;
+    //the opposite edge lies at depth EXTENT - 1, weights of a band reaching it fall to 0 there
+    const size_t DEPTH = std::min( width, EXTENT > 0 ? EXTENT - 1 : 0 );
+    if ( DEPTH <= 1 || ORIGINAL_PROFILE.size() != EDGE_LENGTH || ARRANGED_PROFILE.size() != EDGE_LENGTH )
+    {
+        return;
+    }
+    if ( weightsSpan != DEPTH )
+    {
+        updateWeights(DEPTH);
+    }
+
+    corrections.resize(EDGE_LENGTH);
+    for ( size_t index = 0; index < EDGE_LENGTH; index++ )
+    {
+        corrections[index] = ARRANGED_PROFILE[index] - ORIGINAL_PROFILE[index];
+    }
+
+    //only the band behind the edge is written, so only the band becomes dirty
+    HeightMatrix::DirtyRect band{ 0, 0, MATRIX_WIDTH, MATRIX_HEIGHT };
+    switch (side)
+    {
+    case COMPARISON_SIDE::TOP:
+        band = HeightMatrix::DirtyRect{ 0, 1, MATRIX_WIDTH, DEPTH - 1 };
+        break;
+    case COMPARISON_SIDE::BOTTOM:
+        band = HeightMatrix::DirtyRect{ 0, MATRIX_HEIGHT - DEPTH, MATRIX_WIDTH, DEPTH - 1 };
+        break;
+    case COMPARISON_SIDE::LEFT:
+        band = HeightMatrix::DirtyRect{ 1, 0, DEPTH - 1, MATRIX_HEIGHT };
+        break;
+    case COMPARISON_SIDE::RIGHT:
+        band = HeightMatrix::DirtyRect{ MATRIX_WIDTH - DEPTH, 0, DEPTH - 1, MATRIX_HEIGHT };
+        break;
+    }
+    const size_t STRIDE = matrix.getStride();
+    float * values = matrix.data(band);
+    switch (side)
+    {
+    case COMPARISON_SIDE::TOP:
+        for ( size_t depth = 1; depth < DEPTH; depth++ )
+        {
+            kernel( values + depth * STRIDE, corrections.data(), weights[depth], MATRIX_WIDTH );
+        }
+        break;
+    case COMPARISON_SIDE::BOTTOM:
+        for ( size_t depth = 1; depth < DEPTH; depth++ )
+        {
+            kernel( values + ( MATRIX_HEIGHT - 1 - depth ) * STRIDE, corrections.data(), weights[depth], MATRIX_WIDTH );
+        }
+        break;
+    case COMPARISON_SIDE::LEFT:
+        for ( size_t row = 0; row < MATRIX_HEIGHT; row++ )
+        {
+            kernel( values + row * STRIDE + 1, weights.data() + 1, corrections[row], DEPTH - 1 );
+        }
+        break;
+    case COMPARISON_SIDE::RIGHT:
+        //weights of depths DEPTH - 1 down to 1 lie in front of the right edge in memory order
+        reversedWeights.assign( weights.rend() - DEPTH, weights.rend() - 1 );
+        for ( size_t row = 0; row < MATRIX_HEIGHT; row++ )
+        {
+            kernel( values + row * STRIDE + MATRIX_WIDTH - DEPTH, reversedWeights.data(), corrections[row], DEPTH - 1 );
+        }
+        break;
+    }
+}
+
+/**
+ * @brief picks the widest kernel supported by the CPU
+ */
+EdgeBlender::Kernel EdgeBlender::selectKernel()
+{
+#ifdef COUPLING_X86_SIMD
+    if ( CpuFeatures::hasAvx2() )
+    {
+        return addScaledAvx2;
+    }
+    if ( CpuFeatures::hasSse2() )
+    {
+        return addScaledSse2;
+    }
+#endif
+    return addScaledScalar;
+}
+
+/**
+ * @brief computes falloff weight of every depth of the band
+ * @param span depth at which the weights reach 0, the band width or the distance to the opposite edge
+ */
+void EdgeBlender::updateWeights( size_t span )
+{
+    weightsSpan = span;
+    weights.resize(span);
+    for ( size_t depth = 0; depth < span; depth++ )
+    {
+        float distance = (float)depth / span;
+        weights[depth] = falloff == LINEAR ? 1.0f - distance
+                                           : 1.0f - distance * distance * ( 3.0f - 2.0f * distance );
+    }
+}
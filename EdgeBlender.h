@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include "AlignedAllocator.h"
+#include "HeightMatrix.h"
+
+/**
+ * @brief Spreads the correction of a coupled edge over a band of rows or columns next to it.
+ * A cell at depth d from the edge receives the edge correction of its row or column scaled by the falloff weight of d,
+ * which is 1 at the edge and falls to 0 at the band width, so the slope of the target has no step one cell inside.
+ * A band reaching the opposite edge falls to 0 at that edge instead, which is left untouched.
+ * The band is always processed row by row over contiguous memory: top and bottom bands scale the whole correction line
+ * per row, left and right bands scale the weights by the correction of every row, the kernel is picked once per CPU
+ */
+class EdgeBlender
+{
+public:
+    enum FALLOFF
+    {
+        LINEAR,  //weights fall linearly
+        SMOOTH   //weights fall along a smoothstep, slope is continuous at both ends of the band
+    };
+
+    explicit EdgeBlender( size_t width = 1,
+                          FALLOFF falloff = SMOOTH );
+    void setWidth( size_t width );
+    size_t getWidth() const;
+    void setFalloff( FALLOFF falloff );
+    FALLOFF getFalloff() const;
+    void blend( HeightMatrix & matrix,
+                COMPARISON_SIDE side,
+                const std::vector<float> & ORIGINAL_PROFILE,
+                const std::vector<float> & ARRANGED_PROFILE );
+
+    /**
+     * @brief Kernel adding values scaled by a common factor to a line: line[i] += VALUES[i] * scale
+     */
+    using Kernel = void (*)( float * line,
+                             const float * VALUES,
+                             float scale,
+                             size_t length );
+
+private:
+    static Kernel selectKernel();
+    void updateWeights( size_t span );
+
+private:
+    size_t width;
+    FALLOFF falloff;
+    //falloff weight of every depth of the band, first one belongs to the edge itself
+    std::vector< float, AlignedAllocator<float, 32> > weights;
+    //depth at which the weights reach 0, 0 when they have to be rebuilt
+    size_t weightsSpan;
+    std::vector< float, AlignedAllocator<float, 32> > reversedWeights;
+    std::vector< float, AlignedAllocator<float, 32> > corrections;
+    Kernel kernel;
+};
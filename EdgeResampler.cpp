@@ -0,0 +1,419 @@
+#include "EdgeResampler.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "CpuFeatures.h"
+
+#ifdef COUPLING_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    //weight tables are padded to the widest vector so that kernels may load whole registers
+    constexpr unsigned int WEIGHTS_PADDING = 8;
+
+    /**
+     * @brief Interpolation weights of a step count known at compile time, the same values setSteps computes
+     */
+    template <unsigned int STEPS>
+    struct FixedWeights
+    {
+        float complementWeights[STEPS];
+        float weights[STEPS];
+
+        constexpr FixedWeights()
+            : complementWeights()
+            , weights()
+        {
+            for ( unsigned int step = 0; step < STEPS; step++ )
+            {
+                weights[step] = ( 1.0f / STEPS ) * step;
+                complementWeights[step] = 1.0f - weights[step];
+            }
+        }
+    };
+
+    template <unsigned int STEPS>
+    constexpr FixedWeights<STEPS> FIXED_WEIGHTS{};
+
+    /**
+     * @brief interpolates values of one master segment for steps in [fromStep; toStep)
+     */
+    inline void resampleSegment( const float * MASTER_LINE,
+                                 size_t segment,
+                                 const float * COMPLEMENT_WEIGHTS,
+                                 const float * WEIGHTS,
+                                 unsigned int fromStep,
+                                 unsigned int toStep,
+                                 unsigned int steps,
+                                 float * output )
+    {
+        float value1 = MASTER_LINE[segment];
+        float value2 = MASTER_LINE[segment + 1];
+        for ( unsigned int step = fromStep; step < toStep; step++ )
+        {
+            output[segment * steps + step] = COMPLEMENT_WEIGHTS[step] * value1 + WEIGHTS[step] * value2;
+        }
+    }
+
+    void resampleScalar( const float * MASTER_LINE,
+                         size_t segments,
+                         const float * COMPLEMENT_WEIGHTS,
+                         const float * WEIGHTS,
+                         unsigned int steps,
+                         float * output )
+    {
+        for ( size_t segment = 0; segment < segments; segment++ )
+        {
+            resampleSegment( MASTER_LINE, segment, COMPLEMENT_WEIGHTS, WEIGHTS, 0, steps, steps, output );
+        }
+    }
+
+    /**
+     * @brief scalar kernel of a fixed step count, weights are constants and the steps loop is unrolled by the compiler.
+     * Weight tables and the runtime step count are ignored
+     */
+    template <unsigned int STEPS>
+    void resampleScalarFixed( const float * MASTER_LINE,
+                              size_t segments,
+                              const float *,
+                              const float *,
+                              unsigned int,
+                              float * output )
+    {
+        constexpr const FixedWeights<STEPS> & WEIGHTS = FIXED_WEIGHTS<STEPS>;
+        for ( size_t segment = 0; segment < segments; segment++ )
+        {
+            float value1 = MASTER_LINE[segment];
+            float value2 = MASTER_LINE[segment + 1];
+            float * segmentOutput = output + segment * STEPS;
+            //first step of a segment is the master height itself
+            segmentOutput[0] = value1;
+            for ( unsigned int step = 1; step < STEPS; step++ )
+            {
+                segmentOutput[step] = WEIGHTS.complementWeights[step] * value1 + WEIGHTS.weights[step] * value2;
+            }
+        }
+    }
+
+#ifdef COUPLING_X86_SIMD
+    /**
+     * @brief SSE2 kernel of 2 or 4 steps, 4 segments per iteration
+     */
+    template <unsigned int STEPS>
+    COUPLING_TARGET_SSE2
+    void resampleSse2Fixed( const float * MASTER_LINE,
+                            size_t segments,
+                            const float * COMPLEMENT_WEIGHTS,
+                            const float * WEIGHTS,
+                            unsigned int steps,
+                            float * output )
+    {
+        static_assert( STEPS == 2 || STEPS == 4, "SSE2 kernels are specialized for 2 and 4 steps only" );
+        constexpr const FixedWeights<STEPS> & FIXED = FIXED_WEIGHTS<STEPS>;
+        size_t segment = 0;
+        if constexpr ( STEPS == 2 )
+        {
+            const __m128 COMPLEMENT = _mm_set1_ps( FIXED.complementWeights[1] );
+            const __m128 WEIGHT = _mm_set1_ps( FIXED.weights[1] );
+            for ( ; segment + 4 <= segments; segment += 4 )
+            {
+                __m128 value1 = _mm_loadu_ps( MASTER_LINE + segment );
+                __m128 value2 = _mm_loadu_ps( MASTER_LINE + segment + 1 );
+                __m128 middle = _mm_add_ps( _mm_mul_ps( COMPLEMENT, value1 ), _mm_mul_ps( WEIGHT, value2 ) );
+                _mm_storeu_ps( output + segment * 2, _mm_unpacklo_ps( value1, middle ) );
+                _mm_storeu_ps( output + segment * 2 + 4, _mm_unpackhi_ps( value1, middle ) );
+            }
+        }
+        else
+        {
+            //each step is computed for 4 segments at once and then transposed
+            const __m128 COMPLEMENT1 = _mm_set1_ps( FIXED.complementWeights[1] ), WEIGHT1 = _mm_set1_ps( FIXED.weights[1] );
+            const __m128 COMPLEMENT2 = _mm_set1_ps( FIXED.complementWeights[2] ), WEIGHT2 = _mm_set1_ps( FIXED.weights[2] );
+            const __m128 COMPLEMENT3 = _mm_set1_ps( FIXED.complementWeights[3] ), WEIGHT3 = _mm_set1_ps( FIXED.weights[3] );
+            for ( ; segment + 4 <= segments; segment += 4 )
+            {
+                __m128 value1 = _mm_loadu_ps( MASTER_LINE + segment );
+                __m128 value2 = _mm_loadu_ps( MASTER_LINE + segment + 1 );
+                __m128 step0 = value1;
+                __m128 step1 = _mm_add_ps( _mm_mul_ps( COMPLEMENT1, value1 ), _mm_mul_ps( WEIGHT1, value2 ) );
+                __m128 step2 = _mm_add_ps( _mm_mul_ps( COMPLEMENT2, value1 ), _mm_mul_ps( WEIGHT2, value2 ) );
+                __m128 step3 = _mm_add_ps( _mm_mul_ps( COMPLEMENT3, value1 ), _mm_mul_ps( WEIGHT3, value2 ) );
+                _MM_TRANSPOSE4_PS( step0, step1, step2, step3 );
+                _mm_storeu_ps( output + segment * 4, step0 );
+                _mm_storeu_ps( output + segment * 4 + 4, step1 );
+                _mm_storeu_ps( output + segment * 4 + 8, step2 );
+                _mm_storeu_ps( output + segment * 4 + 12, step3 );
+            }
+        }
+
+        //segments left over from vector iterations
+        resampleScalarFixed<STEPS>( MASTER_LINE + segment, segments - segment, COMPLEMENT_WEIGHTS, WEIGHTS, steps, output + segment * STEPS );
+    }
+
+    /**
+     * @brief SSE2 kernel of any step count, one segment and 4 steps per iteration
+     */
+    COUPLING_TARGET_SSE2
+    void resampleSse2( const float * MASTER_LINE,
+                       size_t segments,
+                       const float * COMPLEMENT_WEIGHTS,
+                       const float * WEIGHTS,
+                       unsigned int steps,
+                       float * output )
+    {
+        size_t segment = 0;
+        if ( steps >= 4 )
+        {
+            for ( ; segment < segments; segment++ )
+            {
+                __m128 value1 = _mm_set1_ps( MASTER_LINE[segment] );
+                __m128 value2 = _mm_set1_ps( MASTER_LINE[segment + 1] );
+                float * segmentOutput = output + segment * steps;
+                unsigned int step = 0;
+                for ( ; step + 4 <= steps; step += 4 )
+                {
+                    __m128 interpolant = _mm_add_ps( _mm_mul_ps( _mm_load_ps( COMPLEMENT_WEIGHTS + step ), value1 ),
+                                                     _mm_mul_ps( _mm_load_ps( WEIGHTS + step ), value2 ) );
+                    _mm_storeu_ps( segmentOutput + step, interpolant );
+                }
+                resampleSegment( MASTER_LINE, segment, COMPLEMENT_WEIGHTS, WEIGHTS, step, steps, steps, output );
+            }
+        }
+
+        //segments left over from vector iterations
+        for ( ; segment < segments; segment++ )
+        {
+            resampleSegment( MASTER_LINE, segment, COMPLEMENT_WEIGHTS, WEIGHTS, 0, steps, steps, output );
+        }
+    }
+
+    /**
+     * @brief AVX2 kernel of 2 or 4 steps, 8 segments per iteration
+     */
+    template <unsigned int STEPS>
+    COUPLING_TARGET_AVX2
+    void resampleAvx2Fixed( const float * MASTER_LINE,
+                            size_t segments,
+                            const float * COMPLEMENT_WEIGHTS,
+                            const float * WEIGHTS,
+                            unsigned int steps,
+                            float * output )
+    {
+        static_assert( STEPS == 2 || STEPS == 4, "AVX2 kernels are specialized for 2 and 4 steps only" );
+        constexpr const FixedWeights<STEPS> & FIXED = FIXED_WEIGHTS<STEPS>;
+        size_t segment = 0;
+        if constexpr ( STEPS == 2 )
+        {
+            //unpack works within 128-bit lanes so halves are reordered before storing
+            const __m256 COMPLEMENT = _mm256_set1_ps( FIXED.complementWeights[1] );
+            const __m256 WEIGHT = _mm256_set1_ps( FIXED.weights[1] );
+            for ( ; segment + 8 <= segments; segment += 8 )
+            {
+                __m256 value1 = _mm256_loadu_ps( MASTER_LINE + segment );
+                __m256 value2 = _mm256_loadu_ps( MASTER_LINE + segment + 1 );
+                __m256 middle = _mm256_add_ps( _mm256_mul_ps( COMPLEMENT, value1 ), _mm256_mul_ps( WEIGHT, value2 ) );
+                __m256 low = _mm256_unpacklo_ps( value1, middle );
+                __m256 high = _mm256_unpackhi_ps( value1, middle );
+                _mm256_storeu_ps( output + segment * 2, _mm256_permute2f128_ps( low, high, 0x20 ) );
+                _mm256_storeu_ps( output + segment * 2 + 8, _mm256_permute2f128_ps( low, high, 0x31 ) );
+            }
+        }
+        else
+        {
+            //4x4 transpose inside each 128-bit lane, then lanes are reordered
+            const __m256 COMPLEMENT1 = _mm256_set1_ps( FIXED.complementWeights[1] ), WEIGHT1 = _mm256_set1_ps( FIXED.weights[1] );
+            const __m256 COMPLEMENT2 = _mm256_set1_ps( FIXED.complementWeights[2] ), WEIGHT2 = _mm256_set1_ps( FIXED.weights[2] );
+            const __m256 COMPLEMENT3 = _mm256_set1_ps( FIXED.complementWeights[3] ), WEIGHT3 = _mm256_set1_ps( FIXED.weights[3] );
+            for ( ; segment + 8 <= segments; segment += 8 )
+            {
+                __m256 value1 = _mm256_loadu_ps( MASTER_LINE + segment );
+                __m256 value2 = _mm256_loadu_ps( MASTER_LINE + segment + 1 );
+                __m256 step0 = value1;
+                __m256 step1 = _mm256_add_ps( _mm256_mul_ps( COMPLEMENT1, value1 ), _mm256_mul_ps( WEIGHT1, value2 ) );
+                __m256 step2 = _mm256_add_ps( _mm256_mul_ps( COMPLEMENT2, value1 ), _mm256_mul_ps( WEIGHT2, value2 ) );
+                __m256 step3 = _mm256_add_ps( _mm256_mul_ps( COMPLEMENT3, value1 ), _mm256_mul_ps( WEIGHT3, value2 ) );
+                __m256 pairs01Low = _mm256_unpacklo_ps( step0, step1 );
+                __m256 pairs01High = _mm256_unpackhi_ps( step0, step1 );
+                __m256 pairs23Low = _mm256_unpacklo_ps( step2, step3 );
+                __m256 pairs23High = _mm256_unpackhi_ps( step2, step3 );
+                //each register holds segment N in the low lane and segment N + 4 in the high lane
+                __m256 segments04 = _mm256_shuffle_ps( pairs01Low, pairs23Low, 0x44 );
+                __m256 segments15 = _mm256_shuffle_ps( pairs01Low, pairs23Low, 0xEE );
+                __m256 segments26 = _mm256_shuffle_ps( pairs01High, pairs23High, 0x44 );
+                __m256 segments37 = _mm256_shuffle_ps( pairs01High, pairs23High, 0xEE );
+                float * blockOutput = output + segment * 4;
+                _mm256_storeu_ps( blockOutput, _mm256_permute2f128_ps( segments04, segments15, 0x20 ) );
+                _mm256_storeu_ps( blockOutput + 8, _mm256_permute2f128_ps( segments26, segments37, 0x20 ) );
+                _mm256_storeu_ps( blockOutput + 16, _mm256_permute2f128_ps( segments04, segments15, 0x31 ) );
+                _mm256_storeu_ps( blockOutput + 24, _mm256_permute2f128_ps( segments26, segments37, 0x31 ) );
+            }
+        }
+
+        //remaining segments go through the 128-bit kernel, upper halves are cleared before legacy SSE code
+        _mm256_zeroupper();
+        resampleSse2Fixed<STEPS>( MASTER_LINE + segment, segments - segment, COMPLEMENT_WEIGHTS, WEIGHTS, steps, output + segment * STEPS );
+    }
+
+    /**
+     * @brief AVX2 kernel of any step count, one segment and 8 steps per iteration
+     */
+    COUPLING_TARGET_AVX2
+    void resampleAvx2( const float * MASTER_LINE,
+                       size_t segments,
+                       const float * COMPLEMENT_WEIGHTS,
+                       const float * WEIGHTS,
+                       unsigned int steps,
+                       float * output )
+    {
+        size_t segment = 0;
+        if ( steps >= 8 )
+        {
+            for ( ; segment < segments; segment++ )
+            {
+                __m256 value1 = _mm256_set1_ps( MASTER_LINE[segment] );
+                __m256 value2 = _mm256_set1_ps( MASTER_LINE[segment + 1] );
+                float * segmentOutput = output + segment * steps;
+                unsigned int step = 0;
+                for ( ; step + 8 <= steps; step += 8 )
+                {
+                    __m256 interpolant = _mm256_add_ps( _mm256_mul_ps( _mm256_load_ps( COMPLEMENT_WEIGHTS + step ), value1 ),
+                                                        _mm256_mul_ps( _mm256_load_ps( WEIGHTS + step ), value2 ) );
+                    _mm256_storeu_ps( segmentOutput + step, interpolant );
+                }
+                resampleSegment( MASTER_LINE, segment, COMPLEMENT_WEIGHTS, WEIGHTS, step, steps, steps, output );
+            }
+        }
+
+        //remaining segments and step counts without a 256-bit path, upper halves are cleared before legacy SSE code
+        _mm256_zeroupper();
+        resampleSse2( MASTER_LINE + segment, segments - segment, COMPLEMENT_WEIGHTS, WEIGHTS, steps, output + segment * steps );
+    }
+#endif
+
+    //kernels indexed by the step count, ratios of the 1, 2 and 4 precisions have specialized kernels,
+    //other counts use the generic kernel at index 0
+    constexpr unsigned int DISPATCH_STEPS = 5;
+    using KernelTable = EdgeResampler::Kernel[DISPATCH_STEPS];
+
+    const KernelTable SCALAR_KERNELS = { resampleScalar, resampleScalar, resampleScalarFixed<2>, resampleScalar, resampleScalarFixed<4> };
+#ifdef COUPLING_X86_SIMD
+    const KernelTable SSE2_KERNELS = { resampleSse2, resampleSse2, resampleSse2Fixed<2>, resampleSse2, resampleSse2Fixed<4> };
+    const KernelTable AVX2_KERNELS = { resampleAvx2, resampleAvx2, resampleAvx2Fixed<2>, resampleAvx2, resampleAvx2Fixed<4> };
+#endif
+}
+
+/**
+ * @param steps number of target values per master segment, i.e. master to target precision ratio
+ */
+EdgeResampler::EdgeResampler( unsigned int steps )
+    : steps(0)
+    , kernels( selectKernels() )
+    , kernel(nullptr)
+{
+    setSteps(steps);
+}
+
+/**
+ * @brief sets number of steps per master segment, weight tables are only rebuilt when the value changes
+ * @param steps number of target values per master segment, at least one
+ */
+void EdgeResampler::setSteps( unsigned int steps )
+{
+    steps = std::max( 1u, steps );
+    if ( steps == this->steps )
+    {
+        return;
+    }
+    this->steps = steps;
+    kernel = kernels[steps < DISPATCH_STEPS ? steps : 0];
+
+    size_t paddedSize = ( steps + WEIGHTS_PADDING - 1 ) / WEIGHTS_PADDING * WEIGHTS_PADDING;
+    complementWeights.assign( paddedSize, 0.0f );
+    weights.assign( paddedSize, 0.0f );
+    float stepDistance = 1.0f / steps;
+    for ( unsigned int step = 0; step < steps; step++ )
+    {
+        float interpolation = stepDistance * step;
+        complementWeights[step] = 1.0f - interpolation;
+        weights[step] = interpolation;
+    }
+}
+
+unsigned int EdgeResampler::getSteps() const
+{
+    return steps;
+}
+
+/**
+ * @brief calculates number of values a master line turns into
+ * @param masterLength number of master heights
+ * @return number of resampled values including the last master height
+ */
+size_t EdgeResampler::getResampledLength( size_t masterLength ) const
+{
+    return masterLength == 0 ? 0 : ( masterLength - 1 ) * steps + 1;
+}
+
+/**
+ * @brief interpolates master heights into a preallocated output
+ * @param MASTER_LINE contiguous master heights
+ * @param masterLength number of master heights
+ * @param output storage for resampled values
+ * @param outputLength capacity of the output, resampling stops when it is exhausted
+ * @return number of values written
+ */
+size_t EdgeResampler::resample( const float * MASTER_LINE,
+                                size_t masterLength,
+                                float * output,
+                                size_t outputLength ) const
+{
+    size_t resampledLength = std::min( getResampledLength(masterLength), outputLength );
+    if ( resampledLength == 0 )
+    {
+        return 0;
+    }
+
+    if ( steps == 1 )
+    {
+        std::memcpy( output, MASTER_LINE, resampledLength * sizeof(float) );
+        return resampledLength;
+    }
+
+    //segments that fit into the output entirely go through the vector kernel
+    size_t fullSegments = std::min( masterLength - 1, resampledLength / steps );
+    kernel( MASTER_LINE, fullSegments, complementWeights.data(), weights.data(), steps, output );
+
+    //partially fitting segment or the last master height
+    if ( fullSegments < masterLength - 1 )
+    {
+        unsigned int partialSteps = (unsigned int)( resampledLength - fullSegments * steps );
+        resampleSegment( MASTER_LINE, fullSegments, complementWeights.data(), weights.data(), 0, partialSteps, steps, output );
+    }
+    else if ( fullSegments * steps < resampledLength )
+    {
+        output[fullSegments * steps] = MASTER_LINE[fullSegments];
+    }
+    return resampledLength;
+}
+
+/**
+ * @brief picks the kernels of the widest instruction set supported by the CPU
+ * @return table of kernels indexed by the step count, its first kernel serves any step count
+ */
+const EdgeResampler::Kernel * EdgeResampler::selectKernels()
+{
+#ifdef COUPLING_X86_SIMD
+    if ( CpuFeatures::hasAvx2() )
+    {
+        return AVX2_KERNELS;
+    }
+    if ( CpuFeatures::hasSse2() )
+    {
+        return SSE2_KERNELS;
+    }
+#endif
+    return SCALAR_KERNELS;
+}
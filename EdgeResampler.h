@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "AlignedAllocator.h"
+
+/**
+ * @brief Resamples a master edge to a finer target precision by linear interpolation.
+ * Every master segment between two adjacent heights is split into a fixed number of steps,
+ * interpolation weights are computed once per number of steps. Kernels are picked from a table of the widest instruction set
+ * of the CPU by the number of steps: 2 and 4 steps, the only ratios of 1, 2 and 4 precisions besides plain copy,
+ * have kernels with compile-time weights and unrolled steps, any other number goes through the generic kernel
+ */
+class EdgeResampler
+{
+public:
+    explicit EdgeResampler( unsigned int steps = 1 );
+    void setSteps( unsigned int steps );
+    unsigned int getSteps() const;
+    size_t getResampledLength( size_t masterLength ) const;
+    size_t resample( const float * MASTER_LINE,
+                     size_t masterLength,
+                     float * output,
+                     size_t outputLength ) const;
+
+    /**
+     * @brief Kernel writing steps values for each of the given number of master segments
+     */
+    using Kernel = void (*)( const float * MASTER_LINE,
+                             size_t segments,
+                             const float * COMPLEMENT_WEIGHTS,
+                             const float * WEIGHTS,
+                             unsigned int steps,
+                             float * output );
+
+private:
+    static const Kernel * selectKernels();
+
+private:
+    unsigned int steps;
+    //weight of the segment start (1 - w) and of the segment end (w) for each step
+    std::vector< float, AlignedAllocator<float, 32> > complementWeights;
+    std::vector< float, AlignedAllocator<float, 32> > weights;
+    const Kernel * kernels;
+    Kernel kernel;
+};
@@ -0,0 +1,270 @@
+#include "FrameProfiler.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+namespace
+{
+    //names in the order of STAGE values
+    const char * const STAGE_NAMES[FrameProfiler::STAGES_COUNT] = { "mesh build",
+                                                                    "buffer upload",
+                                                                    "flat grid draw",
+                                                                    "mesh draw",
+                                                                    "comparison line draw",
+                                                                    "coordinate system draw",
+                                                                    "frame" };
+}
+
+FrameProfiler::Scope::Scope( FrameProfiler * profiler,
+                             STAGE stage )
+    : profiler(profiler)
+    , stage(stage)
+{
+    if (profiler)
+    {
+        profiler->begin(stage);
+    }
+}
+
+FrameProfiler::Scope::~Scope()
+{
+    if (profiler)
+    {
+        profiler->end(stage);
+    }
+}
+
+/**
+ * @param functions OpenGL functions of the current context, queries are created in it
+ */
+FrameProfiler::FrameProfiler( QOpenGLFunctions_4_3_Core & functions )
+    : functions(functions)
+    , querySet(0)
+    , activeGpuStage(-1)
+    , frame(1)
+{
+    for ( int set = 0; set < 2; set++ )
+    {
+        functions.glGenQueries( STAGES_COUNT, queries[set] );
+        std::fill( queryFrames[set], queryFrames[set] + STAGES_COUNT, 0 );
+    }
+    resetFrame( currentFrame, frame );
+    history.reserve(HISTORY_FRAMES);
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    for ( int set = 0; set < 2; set++ )
+    {
+        functions.glDeleteQueries( STAGES_COUNT, queries[set] );
+    }
+}
+
+/**
+ * @brief starts timing of a stage, GPU timing is skipped if another GPU stage is being timed
+ * @param stage stage
+ */
+void FrameProfiler::begin( STAGE stage )
+{
+    stageStarts[stage] = Clock::now();
+    if ( isGpuStage(stage) && activeGpuStage < 0 && queryFrames[querySet][stage] != frame )
+    {
+        functions.glBeginQuery( GL_TIME_ELAPSED, queries[querySet][stage] );
+        activeGpuStage = stage;
+    }
+}
+
+/**
+ * @brief stops timing of a stage started by begin
+ * @param stage stage
+ */
+void FrameProfiler::end( STAGE stage )
+{
+    double & cpuMilliseconds = currentFrame.cpuMilliseconds[stage];
+    cpuMilliseconds = std::max( cpuMilliseconds, 0.0 ) +
+                      std::chrono::duration<double, std::milli>( Clock::now() - stageStarts[stage] ).count();
+    if ( activeGpuStage == stage )
+    {
+        functions.glEndQuery(GL_TIME_ELAPSED);
+        queryFrames[querySet][stage] = frame;
+        activeGpuStage = -1;
+    }
+}
+
+/**
+ * @brief closes the current frame: stores its CPU timings, reads GPU timings of the previous frame if they are ready
+ * and rewrites the log every LOG_INTERVAL_FRAMES frames
+ */
+void FrameProfiler::endFrame()
+{
+    size_t historyIndex = ( frame - 1 ) % HISTORY_FRAMES;
+    if ( history.size() <= historyIndex )
+    {
+        history.push_back(currentFrame);
+    }
+    else
+    {
+        history[historyIndex] = currentFrame;
+    }
+
+    //the other set was issued in the previous frame, it is reused by the next one
+    querySet = 1 - querySet;
+    collectQueries(querySet);
+
+    if ( !logPath.isEmpty() && frame % LOG_INTERVAL_FRAMES == 0 )
+    {
+        writeLog(logPath);
+    }
+    frame++;
+    resetFrame( currentFrame, frame );
+}
+
+/**
+ * @param PATH file the rolling log is written to, empty to disable the log
+ */
+void FrameProfiler::setLogPath( const QString & PATH )
+{
+    logPath = PATH;
+}
+
+/**
+ * @brief writes timings of the frames in history as a JSON array, oldest frame first, unmeasured timings are omitted
+ * @param PATH output file
+ * @return false if the file could not be written
+ */
+bool FrameProfiler::writeLog( const QString & PATH ) const
+{
+    std::vector<const FrameTimes *> frames;
+    frames.reserve( history.size() );
+    for ( const FrameTimes & TIMES : history )
+    {
+        frames.push_back(&TIMES);
+    }
+    std::sort( frames.begin(), frames.end(), []( const FrameTimes * A, const FrameTimes * B ) {
+        return A->frame < B->frame;
+    } );
+
+    QJsonArray framesArray;
+    for ( const FrameTimes * TIMES : frames )
+    {
+        QJsonObject stages;
+        for ( int stage = 0; stage < STAGES_COUNT; stage++ )
+        {
+            QJsonObject stageTimes;
+            if ( TIMES->cpuMilliseconds[stage] >= 0.0 )
+            {
+                stageTimes["cpuMs"] = TIMES->cpuMilliseconds[stage];
+            }
+            if ( TIMES->gpuMilliseconds[stage] >= 0.0 )
+            {
+                stageTimes["gpuMs"] = TIMES->gpuMilliseconds[stage];
+            }
+            if ( !stageTimes.isEmpty() )
+            {
+                stages[STAGE_NAMES[stage]] = stageTimes;
+            }
+        }
+        QJsonObject frameObject;
+        frameObject["frame"] = (double)TIMES->frame;
+        frameObject["stages"] = stages;
+        framesArray.append(frameObject);
+    }
+
+    QFile file(PATH);
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        qWarning( "Unable to write frame timings log %s", qPrintable(PATH) );
+        return false;
+    }
+    file.write( QJsonDocument(framesArray).toJson() );
+    return true;
+}
+
+/**
+ * @brief average CPU and GPU time of every stage over the frames in history, one line per stage
+ */
+QString FrameProfiler::getOverlayText() const
+{
+    QString text = QString::asprintf( "last %d frames, ms", (int)history.size() );
+    for ( int stage = 0; stage < STAGES_COUNT; stage++ )
+    {
+        double cpuSum = 0.0;
+        double gpuSum = 0.0;
+        int cpuCount = 0;
+        int gpuCount = 0;
+        for ( const FrameTimes & TIMES : history )
+        {
+            if ( TIMES.cpuMilliseconds[stage] >= 0.0 )
+            {
+                cpuSum += TIMES.cpuMilliseconds[stage];
+                cpuCount++;
+            }
+            if ( TIMES.gpuMilliseconds[stage] >= 0.0 )
+            {
+                gpuSum += TIMES.gpuMilliseconds[stage];
+                gpuCount++;
+            }
+        }
+        text += QString::asprintf( "\n%s: cpu ", STAGE_NAMES[stage] );
+        text += cpuCount > 0 ? QString::number( cpuSum / cpuCount, 'f', 3 ) : QString("-");
+        text += " gpu ";
+        text += gpuCount > 0 ? QString::number( gpuSum / gpuCount, 'f', 3 ) : QString("-");
+    }
+    return text;
+}
+
+const char * FrameProfiler::stageName( STAGE stage )
+{
+    return STAGE_NAMES[stage];
+}
+
+/**
+ * @brief whether a stage issues GPU commands worth a timer query
+ * @param stage stage
+ */
+bool FrameProfiler::isGpuStage( STAGE stage )
+{
+    //frame encloses the other stages and time elapsed queries cannot be nested
+    return stage != MESH_BUILD && stage != FRAME;
+}
+
+void FrameProfiler::resetFrame( FrameTimes & times,
+                                uint64_t frameNumber )
+{
+    times.frame = frameNumber;
+    std::fill( times.cpuMilliseconds, times.cpuMilliseconds + STAGES_COUNT, -1.0 );
+    std::fill( times.gpuMilliseconds, times.gpuMilliseconds + STAGES_COUNT, -1.0 );
+}
+
+/**
+ * @brief reads results of the queries of a set which are already available, others are dropped, so the set can be reused
+ * @param set query set
+ */
+void FrameProfiler::collectQueries( int set )
+{
+    for ( int stage = 0; stage < STAGES_COUNT; stage++ )
+    {
+        uint64_t issuedFrame = queryFrames[set][stage];
+        if ( issuedFrame == 0 )
+        {
+            continue;
+        }
+        queryFrames[set][stage] = 0;
+        GLint available = 0;
+        functions.glGetQueryObjectiv( queries[set][stage], GL_QUERY_RESULT_AVAILABLE, &available );
+        if ( !available )
+        {
+            continue;
+        }
+        GLuint64 nanoseconds = 0;
+        functions.glGetQueryObjectui64v( queries[set][stage], GL_QUERY_RESULT, &nanoseconds );
+        FrameTimes & times = history[( issuedFrame - 1 ) % HISTORY_FRAMES];
+        if ( times.frame == issuedFrame )
+        {
+            times.gpuMilliseconds[stage] = nanoseconds / 1e6;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QOpenGLFunctions_4_3_Core>
+#include <QString>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Per-stage CPU and GPU timings of the frames of one view.
+ * CPU time is measured with a steady clock, GPU time with GL_TIME_ELAPSED queries. Queries are double-buffered:
+ * results of a frame are read after the next frame, and only if they are already available, so the profiler never stalls the pipeline.
+ * Timings of the last HISTORY_FRAMES frames are kept for the overlay and optionally written to a rolling JSON log
+ * @note time elapsed queries cannot be nested, GPU stages must not overlap; a stage run several times within a frame
+ * accumulates its CPU time, while its GPU time is the one of its first run
+ */
+class FrameProfiler
+{
+public:
+    enum STAGE
+    {
+        MESH_BUILD,             //CPU only, grid mesh rebuilt from the matrix
+        BUFFER_UPLOAD,          //vertex, index and height texture uploads
+        FLAT_GRID_DRAW,
+        MESH_DRAW,              //matrix mesh or mosaic, including chunks culling
+        COMPARISON_LINE_DRAW,
+        COORDINATE_SYSTEM_DRAW,
+        FRAME,                  //CPU only, whole paint of the view
+        STAGES_COUNT
+    };
+
+    /**
+     * @brief Times a stage from construction to destruction, does nothing without a profiler
+     */
+    class Scope
+    {
+    public:
+        Scope( FrameProfiler * profiler,
+               STAGE stage );
+        ~Scope();
+        Scope( const Scope & ) = delete;
+        Scope & operator=( const Scope & ) = delete;
+
+    private:
+        FrameProfiler * profiler;
+        STAGE stage;
+    };
+
+    //frames kept for the overlay averages and the log
+    constexpr static size_t HISTORY_FRAMES = 120;
+    //log is rewritten every this many frames
+    constexpr static uint64_t LOG_INTERVAL_FRAMES = 30;
+
+    explicit FrameProfiler( QOpenGLFunctions_4_3_Core & functions );
+    ~FrameProfiler();
+    FrameProfiler( const FrameProfiler & ) = delete;
+    FrameProfiler & operator=( const FrameProfiler & ) = delete;
+    void begin( STAGE stage );
+    void end( STAGE stage );
+    void endFrame();
+    void setLogPath( const QString & PATH );
+    bool writeLog( const QString & PATH ) const;
+    QString getOverlayText() const;
+    static const char * stageName( STAGE stage );
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Timings of one frame in milliseconds, negative when a stage was not measured
+     */
+    struct FrameTimes
+    {
+        uint64_t frame;
+        double cpuMilliseconds[STAGES_COUNT];
+        double gpuMilliseconds[STAGES_COUNT];
+    };
+
+    static bool isGpuStage( STAGE stage );
+    static void resetFrame( FrameTimes & times,
+                            uint64_t frameNumber );
+    void collectQueries( int set );
+
+private:
+    QOpenGLFunctions_4_3_Core & functions;
+    GLuint queries[2][STAGES_COUNT];
+    //frame a query was issued in, queries not issued in their last frame have 0
+    uint64_t queryFrames[2][STAGES_COUNT];
+    int querySet;
+    //only one time elapsed query may be active
+    int activeGpuStage;
+    Clock::time_point stageStarts[STAGES_COUNT];
+    uint64_t frame;
+    FrameTimes currentFrame;
+    //ring of the last frames, frame f is at (f - 1) % HISTORY_FRAMES
+    std::vector<FrameTimes> history;
+    QString logPath;
+};
@@ -3,40 +3,81 @@
 #include <QOpenGLShaderProgram>
 
 Grid::Grid( QOpenGLShaderProgram & shaderProgram,
+            QOpenGLShaderProgram & textureShaderProgram,
             QOpenGLFunctions_4_3_Core & functions )
     : shaderProgram(shaderProgram)
-    , width(0)
-    , height(0)
-    , flatGridVerticesCount(0)
-    , matrixGridVerticesCount(0)
-    , indicesOffsetFromFlatGrid(0)
-    , comparisonSideVerticesCount(0)
+    , textureShaderProgram(textureShaderProgram)
     , functions(functions)
+    , layoutBuffer( functions, GL_ARRAY_BUFFER, GL_STATIC_DRAW )
+    , heightsBuffer( functions, GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW )
+    , indexBuffer( functions, GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW )
+    , comparisonSideBuffer( functions, GL_ARRAY_BUFFER, GL_STREAM_DRAW )
+    , comparisonSideFirst(0)
+    , textureWidth(0)
+    , textureHeight(0)
+    , textureMatrixId(0)
+    , texturePrecision(1.0f)
+    , renderMode(VERTEX_MESH)
     , flatGridVisible(false)
+    , profiler(nullptr)
 {
     functions.glGenVertexArrays( 1, &vao );
-    functions.glGenBuffers( 1, &vbo );
-    functions.glGenBuffers( 1, &ebo );
     functions.glBindVertexArray(vao);
-    functions.glBindBuffer( GL_ARRAY_BUFFER, vbo );
-    functions.glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+    //(x;z) layout and heights are separate streams, so that heights can be updated alone
+    layoutBuffer.bind();
+    functions.glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 0, 0 );
     functions.glEnableVertexAttribArray(0);
+    heightsBuffer.bind();
+    functions.glVertexAttribPointer( 1, 1, GL_FLOAT, GL_FALSE, 0, 0 );
+    functions.glEnableVertexAttribArray(1);
+    indexBuffer.bind();
 
     //GL_PRIMITIVE_RESTART is used for height matrix grid rendering
     functions.glEnable(GL_PRIMITIVE_RESTART);
-    functions.glPrimitiveRestartIndex(PRIMITIVE_RESTART_INDEX);
+    functions.glPrimitiveRestartIndex(GridMesh::PRIMITIVE_RESTART_INDEX);
+
+    //comparison line has its own (x;y;z) buffer, rewritten on every coupling, so it is streamed
+    functions.glGenVertexArrays( 1, &comparisonSideVao );
+    functions.glBindVertexArray(comparisonSideVao);
+    comparisonSideBuffer.bind();
+    functions.glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+    functions.glEnableVertexAttribArray(0);
+
+    //height texture mode needs no vertex attributes at all, but core profile still requires a bound vertex array object
+    functions.glGenVertexArrays( 1, &textureVao );
+    functions.glGenTextures( 1, &heightTexture );
+    functions.glBindTexture( GL_TEXTURE_2D, heightTexture );
+    //heights are read with texelFetch only, texture must nevertheless be complete without mipmaps
+    functions.glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    functions.glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    functions.glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0 );
+    functions.glBindTexture( GL_TEXTURE_2D, 0 );
     functions.glBindVertexArray(0);
+
+    //locations are resolved once, uniforms which never change are set once as well
+    uniforms.resolve(shaderProgram);
+    textureUniforms.resolve(textureShaderProgram);
+    textureShaderProgram.bind();
+    textureShaderProgram.setUniformValue( textureUniforms[UniformLocationCache::HEIGHTS], 0 );
+    textureShaderProgram.setUniformValue( textureUniforms[UniformLocationCache::COLOR], QVector4D( 1.0f, 1.0f, 1.0f, 1.0f ) );
+    textureShaderProgram.setUniformValue( textureUniforms[UniformLocationCache::APPLY_HEIGHT_COLORING], true );
+    textureShaderProgram.release();
 }
 
 Grid::~Grid()
 {
-    functions.glDeleteBuffers( 1, &vbo );
-    functions.glDeleteBuffers( 1, &ebo );
     functions.glDeleteVertexArrays( 1, &vao );
+    functions.glDeleteVertexArrays( 1, &comparisonSideVao );
+    functions.glDeleteTextures( 1, &heightTexture );
+    functions.glDeleteVertexArrays( 1, &textureVao );
 }
 
 /**
- * @brief updates grids data and related buffers
+ * @brief updates grids data and related buffers.
+ * Layout and indices are uploaded only when they have been rebuilt, otherwise only changed ranges of heights are sent.
+ * In height texture mode the layout holds flat grid only and heights go to the texture.
+ * Heights of the matrix of the previous update are read only inside its dirty rectangles, which must not be cleared
+ * before the update that follows its modification, all heights of any other matrix are read, see GridMesh::update
  * @param MATRIX matrix
  * @param side side of the matrix
  * @param comparisonOnly flag indicating that only comparison line data should be updated
@@ -49,235 +90,225 @@ void Grid::update( const HeightMatrix & MATRIX,
     {
         return;
     }
-    if ( !comparisonOnly )
     {
-        int oldWidth = width;
-        int oldHeight = height;
-
-        //update dimensions
-        const double MATRIX_PRECISION = MATRIX.getPrecision();
-        width = MATRIX.getWidth() * MATRIX_PRECISION;
-        height = MATRIX.getHeight() * MATRIX_PRECISION;
-        indices.clear();
-
-        //update both flat grid and matrix mesh with comparison line
-        if ( oldWidth != width || oldHeight != height )
-        {
-            vertices.clear();
-            indices.clear();
-            indicesOffsetFromFlatGrid = 0;
-            flatGridVerticesCount = 0;
-            updateFlatGridVertices( MATRIX_PRECISION );
-        }
-        //update only matrix mesh and comparison line
-        else
-        {
-            vertices.resize( flatGridVerticesCount * 3 );
-            indicesOffsetFromFlatGrid = flatGridVerticesCount;
-        }
-
-        matrixGridVerticesCount = 0;
-        updateMatrixGridVertices(MATRIX);
+        FrameProfiler::Scope scope( profiler, FrameProfiler::MESH_BUILD );
+        mesh.update( MATRIX, side, comparisonOnly );
     }
-    //update only comparison line
-    else
+    FrameProfiler::Scope scope( profiler, FrameProfiler::BUFFER_UPLOAD );
+    if ( renderMode == HEIGHT_TEXTURE && !comparisonOnly )
     {
-        vertices.resize( flatGridVerticesCount * 3 + matrixGridVerticesCount * 3 );
+        updateHeightTexture(MATRIX);
     }
+    const std::vector<float> & HEIGHTS = mesh.getHeights();
 
-    comparisonSideVerticesCount = 0;
-    updateComparisonSideVertices( MATRIX, side );
-
+    //element buffer binding belongs to the vertex array object
     functions.glBindVertexArray(vao);
-    functions.glBindBuffer( GL_ARRAY_BUFFER, vbo );
-    functions.glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW );
+    if ( mesh.isLayoutChanged() )
+    {
+        const std::vector<float> & LAYOUT = mesh.getLayout();
+        const std::vector<uint32_t> & INDICES = mesh.getIndices();
+        layoutBuffer.assign( LAYOUT.data(), LAYOUT.size() * sizeof(float) );
+        heightsBuffer.assign( HEIGHTS.data(), HEIGHTS.size() * sizeof(float) );
+        indexBuffer.assign( INDICES.data(), INDICES.size() * sizeof(GLuint) );
+    }
+    else
+    {
+        for ( const GridMesh::HeightsRange & RANGE : mesh.getChangedHeights() )
+        {
+            heightsBuffer.updateRange( RANGE.first * sizeof(float), HEIGHTS.data() + RANGE.first, RANGE.count * sizeof(float) );
+        }
+    }
+    functions.glBindVertexArray(0);
 
-    functions.glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ebo );
-    functions.glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW );
+    const std::vector<float> & COMPARISON_SIDE_VERTICES = mesh.getComparisonSideVertices();
+    const GLsizeiptr COMPARISON_SIDE_VERTEX_SIZE = 3 * sizeof(float);
+    GLintptr offset = comparisonSideBuffer.stream( COMPARISON_SIDE_VERTICES.data(),
+                                                   COMPARISON_SIDE_VERTICES.size() * sizeof(float),
+                                                   COMPARISON_SIDE_VERTEX_SIZE );
+    comparisonSideFirst = (GLint)( offset / COMPARISON_SIDE_VERTEX_SIZE );
 }
 
 /**
- * @brief updates flat grid vertices storage
- * @param matrixPrecision precision of the matrix
+ * @brief draw function, camera matrices must already be in the camera uniform block
+ * @param PROJECTION_MATRIX projection matrix, used for chunks culling
+ * @param VIEW_MATRIX view matrix, used for chunks culling
  */
-void Grid::updateFlatGridVertices( int matrixPrecision )
+void Grid::draw( const QMatrix4x4 & PROJECTION_MATRIX,
+                 const QMatrix4x4 & VIEW_MATRIX )
 {
-    int halfWidth = width / 2;
-    int halfHeight = height / 2;
-    auto bufferFlatGridVertex = [this]( FlatGridVertex && gridVertex ) {
-        vertices.emplace_back( gridVertex.x );
-        vertices.emplace_back( 0.0f );
-        vertices.emplace_back( gridVertex.z );
-        flatGridVerticesCount++;
-    };
+    shaderProgram.bind();
+    shaderProgram.setUniformValue( uniforms[UniformLocationCache::APPLY_HEIGHT_COLORING], false );
+    shaderProgram.setUniformValue( uniforms[UniformLocationCache::SEPARATE_HEIGHTS], true );
 
-    //create lines parallel to X axis (count is equal to height of the grid plus one extra at z = 0.0)
-    for ( int z = -halfHeight; z <= halfHeight - matrixPrecision; z++ )
-    {
-        // (-X;z) vertex
-        FlatGridVertex negX{ (float)(-halfWidth), (float)z };
-        bufferFlatGridVertex( std::move(negX) );
-        indicesOffsetFromFlatGrid++;
+    functions.glBindVertexArray(vao);
 
-        // (X;z) vertex
-        FlatGridVertex posX{ (float)(halfWidth - matrixPrecision), (float)z };
-        bufferFlatGridVertex( std::move(posX) );
-        indicesOffsetFromFlatGrid++;
+    //render flat grid if necessary
+    if (flatGridVisible)
+    {
+        FrameProfiler::Scope scope( profiler, FrameProfiler::FLAT_GRID_DRAW );
+        shaderProgram.setUniformValue( uniforms[UniformLocationCache::COLOR], QVector4D( 0.4f, 0.2f, 0.4f, 1.0f ) );
+        functions.glDrawArrays( GL_LINES, 0, mesh.getFlatGridVerticesCount() );
     }
 
-    //create lines parallel to Z axis (count is equal to width of the grid plus one extra at x = 0.0)
-    for ( int x = -halfWidth; x <= halfWidth - matrixPrecision; x++ )
+    //render chunks of height matrix grid in view using EBO with primitive restart mode or the whole grid from the height texture
+    if ( renderMode == VERTEX_MESH )
     {
-        // (x;-Z) vertex
-        FlatGridVertex negZ{ (float)x, (float)(-halfHeight) };
-        bufferFlatGridVertex( std::move(negZ) );
-        indicesOffsetFromFlatGrid++;
-
-        // (x;Z) vertex
-        FlatGridVertex posZ{ (float)x, (float)(halfHeight - matrixPrecision) };
-        bufferFlatGridVertex( std::move(posZ) );
-        indicesOffsetFromFlatGrid++;
+        FrameProfiler::Scope scope( profiler, FrameProfiler::MESH_DRAW );
+        updateVisibleChunks( PROJECTION_MATRIX * VIEW_MATRIX );
+        if ( !visibleChunksCounts.empty() )
+        {
+            shaderProgram.setUniformValue( uniforms[UniformLocationCache::COLOR], QVector4D( 1.0f, 1.0f, 1.0f, 1.0f ) );
+            shaderProgram.setUniformValue( uniforms[UniformLocationCache::APPLY_HEIGHT_COLORING], true );
+            functions.glMultiDrawElements( GL_LINE_STRIP, visibleChunksCounts.data(), GL_UNSIGNED_INT,
+                                           visibleChunksOffsets.data(), (GLsizei)visibleChunksCounts.size() );
+            shaderProgram.setUniformValue( uniforms[UniformLocationCache::APPLY_HEIGHT_COLORING], false );
+        }
     }
+    else
+    {
+        FrameProfiler::Scope scope( profiler, FrameProfiler::MESH_DRAW );
+        drawHeightTexture();
+        shaderProgram.bind();
+    }
+
+    //render matrix current comparison line strip
+    FrameProfiler::Scope scope( profiler, FrameProfiler::COMPARISON_LINE_DRAW );
+    shaderProgram.setUniformValue( uniforms[UniformLocationCache::SEPARATE_HEIGHTS], false );
+    functions.glBindVertexArray(comparisonSideVao);
+    functions.glLineWidth(2.0f);
+    shaderProgram.setUniformValue( uniforms[UniformLocationCache::COLOR], QVector4D( 1.0f, 1.0f, 0.0f, 1.0f ) );
+    functions.glDrawArrays( GL_LINE_STRIP, comparisonSideFirst, mesh.getComparisonSideVerticesCount() );
+    comparisonSideBuffer.fence();
+    functions.glLineWidth(1.0f);
+    functions.glBindVertexArray(0);
 }
 
 /**
- * @brief updates grid vertices storage of the matrix
- * @param MATRIX matrix
+ * @brief collects index ranges of the chunks whose bounding boxes intersect the view frustum,
+ * ranges of chunks adjacent in the index buffer are merged into one draw
+ * @param VIEW_PROJECTION_MATRIX product of projection and view matrices
  */
-void Grid::updateMatrixGridVertices( const HeightMatrix & MATRIX )
+void Grid::updateVisibleChunks( const QMatrix4x4 & VIEW_PROJECTION_MATRIX )
 {
-    int halfWidth = width / 2;
-    int halfHeight = height / 2;
-    float precision = (float)MATRIX.getPrecision();
-    auto bufferMatrixGridVertex = [this]( MatrixGridVertex && heightMatrixVertex ) {
-        vertices.emplace_back( heightMatrixVertex.x );
-        vertices.emplace_back( heightMatrixVertex.y );
-        vertices.emplace_back( heightMatrixVertex.z );
-        matrixGridVerticesCount++;
-    };
-
-    //create line strips parallel to X axis (count is equal to height of the grid plus one extra at z = 0.0)
-    for ( HeightMatrix::ConstColumnIterator column = MATRIX.columnBegin(0); column.isValid(); column++ )
+    //frustum planes extracted from the clip matrix rows, a point is inside when it is on the positive side of every plane
+    const QVector4D LAST_ROW = VIEW_PROJECTION_MATRIX.row(3);
+    QVector4D planes[6];
+    for ( int axis = 0; axis < 3; axis++ )
     {
-        for ( HeightMatrix::ConstRowIterator row = MATRIX.rowBegin( column.getCurrentIndex() ); row.isValid(); row++ )
+        planes[axis * 2] = LAST_ROW + VIEW_PROJECTION_MATRIX.row(axis);
+        planes[axis * 2 + 1] = LAST_ROW - VIEW_PROJECTION_MATRIX.row(axis);
+    }
+    auto isChunkVisible = [&planes]( const GridMesh::Chunk & CHUNK ) {
+        for ( const QVector4D & PLANE : planes )
         {
-            MatrixGridVertex v{ row.getCurrentIndex() * precision - halfWidth,
-                                *row,
-                                column.getCurrentIndex() * precision - halfHeight };
-            bufferMatrixGridVertex( std::move(v) );
-            indices.emplace_back( indicesOffsetFromFlatGrid++ );
+            //corner of the box farthest along the plane normal
+            float x = PLANE.x() >= 0.0f ? CHUNK.maxX : CHUNK.minX;
+            float y = PLANE.y() >= 0.0f ? CHUNK.maxY : CHUNK.minY;
+            float z = PLANE.z() >= 0.0f ? CHUNK.maxZ : CHUNK.minZ;
+            if ( PLANE.x() * x + PLANE.y() * y + PLANE.z() * z + PLANE.w() < 0.0f )
+            {
+                return false;
+            }
         }
-        indices.emplace_back(PRIMITIVE_RESTART_INDEX);
-    }
+        return true;
+    };
 
-    //create line strips parallel to Z axis (count is equal to width of the grid plus one extra at x = 0.0)
-    for ( HeightMatrix::ConstRowIterator row = MATRIX.rowBegin(0); row.isValid(); row++ )
+    visibleChunksCounts.clear();
+    visibleChunksOffsets.clear();
+    size_t lastRangeEnd = 0;
+    for ( const GridMesh::Chunk & CHUNK : mesh.getChunks() )
     {
-        for ( HeightMatrix::ConstColumnIterator column = MATRIX.columnBegin( row.getCurrentIndex() ); column.isValid(); column++ )
+        if ( !isChunkVisible(CHUNK) )
+        {
+            continue;
+        }
+        if ( !visibleChunksCounts.empty() && CHUNK.firstIndex == lastRangeEnd )
         {
-            MatrixGridVertex v{ row.getCurrentIndex() * precision - halfWidth,
-                                *column,
-                                column.getCurrentIndex() * precision - halfHeight };
-            bufferMatrixGridVertex( std::move(v) );
-            indices.emplace_back( indicesOffsetFromFlatGrid++ );
+            visibleChunksCounts.back() += (GLsizei)CHUNK.indexCount;
         }
-        indices.emplace_back(PRIMITIVE_RESTART_INDEX);
+        else
+        {
+            visibleChunksCounts.push_back( (GLsizei)CHUNK.indexCount );
+            visibleChunksOffsets.push_back( (const void *)( CHUNK.firstIndex * sizeof(GLuint) ) );
+        }
+        lastRangeEnd = CHUNK.firstIndex + CHUNK.indexCount;
     }
 }
 
 /**
- * @brief updates comparison side vertices storage
+ * @brief uploads matrix heights into the R32F texture, rows are read with the matrix stride so no intermediate copy is made.
+ * A texture of new dimensions gets all heights, otherwise only the dirty rectangles of the matrix are uploaded
  * @param MATRIX matrix
- * @param side side of the matrix
  */
-void Grid::updateComparisonSideVertices( const HeightMatrix & MATRIX,
-                                         COMPARISON_SIDE side )
+void Grid::updateHeightTexture( const HeightMatrix & MATRIX )
 {
-    int halfWidth = width / 2;
-    int halfHeight = height / 2;
+    GLsizei matrixWidth = (GLsizei)MATRIX.getWidth();
+    GLsizei matrixHeight = (GLsizei)MATRIX.getHeight();
+    GLint maxTextureSize = 0;
+    functions.glGetIntegerv( GL_MAX_TEXTURE_SIZE, &maxTextureSize );
+    if ( matrixWidth > maxTextureSize || matrixHeight > maxTextureSize )
+    {
+        qWarning( "Matrix is too large for a height texture, switch to vertex mesh mode to render it" );
+        textureWidth = 0;
+        textureHeight = 0;
+        return;
+    }
     float precision = (float)MATRIX.getPrecision();
-    auto bufferComparisonSideVertex = [this]( MatrixGridVertex && sideVertex ) {
-        vertices.emplace_back( sideVertex.x );
-        vertices.emplace_back( sideVertex.y );
-        vertices.emplace_back( sideVertex.z );
-        comparisonSideVerticesCount++;
-    };
+    texturePrecision = precision;
+    textureOrigin = QVector2D( (float)( -mesh.getWidth() / 2 ), (float)( -mesh.getHeight() / 2 ) );
 
-    switch (side)
+    functions.glBindTexture( GL_TEXTURE_2D, heightTexture );
+    functions.glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+    functions.glPixelStorei( GL_UNPACK_ROW_LENGTH, (GLint)MATRIX.getStride() );
+    if ( matrixWidth != textureWidth || matrixHeight != textureHeight )
     {
-    case COMPARISON_SIDE::LEFT:
-        for ( HeightMatrix::ConstColumnIterator column = MATRIX.columnBegin(0); column.isValid(); column++ )
-        {
-            MatrixGridVertex v{ (float)(-halfWidth),
-                                *column,
-                                column.getCurrentIndex() * precision - halfHeight };
-            bufferComparisonSideVertex( std::move(v) );
-        }
-        break;
-    case COMPARISON_SIDE::RIGHT:
-        for ( HeightMatrix::ConstColumnIterator column = MATRIX.columnBegin( MATRIX.getWidth() - 1 ); column.isValid(); column++ )
-        {
-            MatrixGridVertex v{ (float)halfWidth - precision,
-                                *column,
-                                column.getCurrentIndex() * precision - halfHeight };
-            bufferComparisonSideVertex( std::move(v) );
-        }
-        break;
-    case COMPARISON_SIDE::TOP:
-        for ( HeightMatrix::ConstRowIterator row = MATRIX.rowBegin(0); row.isValid(); row++ )
-        {
-            MatrixGridVertex v{ row.getCurrentIndex() * precision - halfWidth,
-                                *row,
-                                (float)(-halfHeight) };
-            bufferComparisonSideVertex( std::move(v) );
-        }
-        break;
-    case COMPARISON_SIDE::BOTTOM:
-        for ( HeightMatrix::ConstRowIterator row = MATRIX.rowBegin( MATRIX.getHeight() - 1 ); row.isValid(); row++ )
+        textureWidth = matrixWidth;
+        textureHeight = matrixHeight;
+        functions.glTexImage2D( GL_TEXTURE_2D, 0, GL_R32F, textureWidth, textureHeight, 0, GL_RED, GL_FLOAT, MATRIX.data() );
+    }
+    else if ( MATRIX.getId() != textureMatrixId )
+    {
+        //dirty rectangles of another matrix say nothing about the heights the texture holds
+        functions.glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, textureWidth, textureHeight, GL_RED, GL_FLOAT, MATRIX.data() );
+    }
+    else
+    {
+        //texture of the same size already holds the heights, only dirty rectangles are replaced
+        for ( const HeightMatrix::DirtyRect & RECT : MATRIX.getDirtyRects() )
         {
-            MatrixGridVertex v{ row.getCurrentIndex() * precision - halfWidth,
-                                *row,
-                                (float)halfHeight - precision };
-            bufferComparisonSideVertex( std::move(v) );
+            functions.glTexSubImage2D( GL_TEXTURE_2D, 0, (GLint)RECT.column, (GLint)RECT.row, (GLsizei)RECT.width, (GLsizei)RECT.height,
+                                       GL_RED, GL_FLOAT, MATRIX.data() + RECT.row * MATRIX.getStride() + RECT.column );
         }
-        break;
     }
+    functions.glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+    functions.glBindTexture( GL_TEXTURE_2D, 0 );
+    textureMatrixId = MATRIX.getId();
 }
 
 /**
- * @brief draw function
- * @param PROJECTION_MATRIX projection matrix
- * @param VIEW_MATRIX view matrix
+ * @brief draws matrix line strips generated by the vertex shader from the height texture:
+ * one instance per row with one vertex per column, then one instance per column with one vertex per row
  */
-void Grid::draw( const QMatrix4x4 & PROJECTION_MATRIX,
-                 const QMatrix4x4 & VIEW_MATRIX )
+void Grid::drawHeightTexture()
 {
-    //update transformation matrices
-    shaderProgram.bind();
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_projection"), PROJECTION_MATRIX );
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_view"), VIEW_MATRIX );
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_applyHeightColoring"), false );
-
-    functions.glBindVertexArray(vao);
-
-    //render flat grid if necessary
-    if (flatGridVisible)
+    if ( textureWidth == 0 || textureHeight == 0 )
     {
-        shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_color"), QVector4D( 0.4f, 0.2f, 0.4f, 1.0f ) );
-        functions.glDrawArrays( GL_LINES, 0, flatGridVerticesCount );
+        return;
     }
+    textureShaderProgram.bind();
+    textureShaderProgram.setUniformValue( textureUniforms[UniformLocationCache::ORIGIN], textureOrigin );
+    textureShaderProgram.setUniformValue( textureUniforms[UniformLocationCache::PRECISION], texturePrecision );
 
-    //render height matrix grid using EBO with primitive restart mode
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_color"), QVector4D( 1.0f, 1.0f, 1.0f, 1.0f ) );
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_applyHeightColoring"), true );
-    functions.glDrawElements( GL_LINE_STRIP, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0 );
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_applyHeightColoring"), false );
-
-    //render matrix current comparison line strip
-    functions.glLineWidth(2.0f);
-    shaderProgram.setUniformValue( shaderProgram.uniformLocation("u_color"), QVector4D( 1.0f, 1.0f, 0.0f, 1.0f ) );
-    functions.glDrawArrays( GL_LINE_STRIP, flatGridVerticesCount + matrixGridVerticesCount, comparisonSideVerticesCount );
-    functions.glLineWidth(1.0f);
+    functions.glActiveTexture(GL_TEXTURE0);
+    functions.glBindTexture( GL_TEXTURE_2D, heightTexture );
+    functions.glBindVertexArray(textureVao);
+    //every instance is a separate line strip, so no restart index is needed
+    textureShaderProgram.setUniformValue( textureUniforms[UniformLocationCache::COLUMN_STRIPS], false );
+    functions.glDrawArraysInstanced( GL_LINE_STRIP, 0, textureWidth, textureHeight );
+    textureShaderProgram.setUniformValue( textureUniforms[UniformLocationCache::COLUMN_STRIPS], true );
+    functions.glDrawArraysInstanced( GL_LINE_STRIP, 0, textureHeight, textureWidth );
+    functions.glBindVertexArray(0);
+    functions.glBindTexture( GL_TEXTURE_2D, 0 );
 }
 
 
@@ -285,15 +316,40 @@ void Grid::draw( const QMatrix4x4 & PROJECTION_MATRIX,
 
 int Grid::getWidth() const
 {
-    return width;
+    return mesh.getWidth();
 }
 
 int Grid::getHeight() const
 {
-    return height;
+    return mesh.getHeight();
 }
 
 void Grid::setShowFlatGrid( bool isShow )
 {
     flatGridVisible = isShow;
 }
+
+/**
+ * @brief switches between CPU-built vertex mesh and height texture rendering, takes effect on the next update
+ * @param mode render mode
+ */
+void Grid::setRenderMode( RENDER_MODE mode )
+{
+    renderMode = mode;
+    mesh.setMatrixGridEnabled( mode == VERTEX_MESH );
+    textureWidth = 0;
+    textureHeight = 0;
+}
+
+Grid::RENDER_MODE Grid::getRenderMode() const
+{
+    return renderMode;
+}
+
+/**
+ * @param profiler profiler timing mesh building, uploads and draws, nullptr to disable timing
+ */
+void Grid::setProfiler( FrameProfiler * profiler )
+{
+    this->profiler = profiler;
+}
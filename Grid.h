@@ -2,19 +2,32 @@
 
 #include <vector>
 #include <QOpenGLFunctions_4_3_Core>
+#include <QVector2D>
 #include <memory>
 
-#include "HeightMatrix.h"
+#include "FrameProfiler.h"
+#include "GridMesh.h"
+#include "StreamingBuffer.h"
+#include "UniformLocationCache.h"
 
 class QOpenGLShaderProgram;
 
 /**
- * @brief Represents grid mesh of a matrix and optionally flat grid layer
+ * @brief Represents grid mesh of a matrix and optionally flat grid layer, renders data built by GridMesh.
+ * Matrix mesh is either uploaded as vertices, drawn by chunks culled against the view frustum,
+ * or derived in the vertex shader from the heights uploaded as a texture
  */
 class Grid
 {
 public:
+    enum RENDER_MODE
+    {
+        VERTEX_MESH,    //line strip vertices are built on CPU, about 24 bytes per cell
+        HEIGHT_TEXTURE  //heights are an R32F texture, line strips are generated from vertex and instance IDs, 4 bytes per cell
+    };
+
     Grid( QOpenGLShaderProgram & shaderProgram,
+          QOpenGLShaderProgram & textureShaderProgram,
           QOpenGLFunctions_4_3_Core & functions );
     ~Grid();
     void update( const HeightMatrix & MATRIX,
@@ -23,37 +36,44 @@ public:
     int getWidth() const;
     int getHeight() const;
     void setShowFlatGrid( bool isShow );
+    void setRenderMode( RENDER_MODE mode );
+    RENDER_MODE getRenderMode() const;
+    void setProfiler( FrameProfiler * profiler );
     void draw( const QMatrix4x4 & PROJECTION_MATRIX,
                const QMatrix4x4 & VIEW_MATRIX );
 
 private:
-    const GLuint PRIMITIVE_RESTART_INDEX = 0xFFFF;
-    struct FlatGridVertex
-    {
-        float x, z;
-    };
-    struct MatrixGridVertex
-    {
-        float x, y, z;
-    };
+    void updateVisibleChunks( const QMatrix4x4 & VIEW_PROJECTION_MATRIX );
+    void updateHeightTexture( const HeightMatrix & MATRIX );
+    void drawHeightTexture();
 
-    void updateFlatGridVertices( int matrixPrecision );
-    void updateMatrixGridVertices( const HeightMatrix & MATRIX );
-    void updateComparisonSideVertices( const HeightMatrix & MATRIX,
-                                       COMPARISON_SIDE side );
 private:
-    std::vector<float> vertices;
-    std::vector<GLuint> indices;
+    GridMesh mesh;
     QOpenGLShaderProgram & shaderProgram;
-    int width;
-    int height;
-    GLuint flatGridVerticesCount;
-    GLuint matrixGridVerticesCount;
-    GLuint indicesOffsetFromFlatGrid;
-    GLuint comparisonSideVerticesCount;
+    QOpenGLShaderProgram & textureShaderProgram;
     QOpenGLFunctions_4_3_Core & functions;
+    UniformLocationCache uniforms;
+    UniformLocationCache textureUniforms;
     GLuint vao;
-    GLuint vbo;
-    GLuint ebo;
+    StreamingBuffer layoutBuffer;
+    StreamingBuffer heightsBuffer;
+    StreamingBuffer indexBuffer;
+    GLuint comparisonSideVao;
+    StreamingBuffer comparisonSideBuffer;
+    //first vertex of the comparison line in its streaming buffer
+    GLint comparisonSideFirst;
+    //index ranges of matrix mesh chunks in view, arguments of the multi-draw call
+    std::vector<GLsizei> visibleChunksCounts;
+    std::vector<const void *> visibleChunksOffsets;
+    GLuint heightTexture;
+    GLuint textureVao;
+    GLsizei textureWidth;
+    GLsizei textureHeight;
+    //id of the matrix whose heights the texture holds
+    uint64_t textureMatrixId;
+    QVector2D textureOrigin;
+    float texturePrecision;
+    RENDER_MODE renderMode;
     bool flatGridVisible;
+    FrameProfiler * profiler;
 };
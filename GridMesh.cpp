@@ -0,0 +1,630 @@
+#include "GridMesh.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "ParallelFor.h"
+
+namespace
+{
+    //unchanged heights between two changed ranges closer than that are uploaded too, which is cheaper than one more upload call
+    constexpr size_t CHANGED_RANGES_MERGE_GAP = 256;
+    //strips are grouped into jobs of at least that many vertices, so small matrices are not spread over threads at all
+    constexpr size_t MIN_VERTICES_PER_JOB = 16 * 1024;
+
+    inline size_t linesPerJob( size_t lineLength )
+    {
+        return std::max( (size_t)1, MIN_VERTICES_PER_JOB / std::max( (size_t)1, lineLength ) );
+    }
+}
+
+GridMesh::GridMesh()
+    : layoutChanged(false)
+    , allHeightsChanged(false)
+    , matrixGridEnabled(true)
+    , layoutHasMatrixGrid(true)
+    , matrixWidth(0)
+    , matrixHeight(0)
+    , matrixPrecision(0.0)
+    , matrixId(0)
+    , width(0)
+    , height(0)
+    , flatGridVerticesCount(0)
+    , matrixGridVerticesCount(0)
+    , chunksPerRow(0)
+{}
+
+/**
+ * @brief sets whether matrix mesh layout and heights are built, takes effect on the next full update
+ * @param enabled false to keep only flat grid and comparison line
+ */
+void GridMesh::setMatrixGridEnabled( bool enabled )
+{
+    matrixGridEnabled = enabled;
+}
+
+bool GridMesh::isMatrixGridEnabled() const
+{
+    return matrixGridEnabled;
+}
+
+/**
+ * @brief updates grids data, layout is rebuilt only when the matrix dimensions, precision or matrix mesh presence change.
+ * With the layout kept only heights inside the dirty rectangles of the matrix of the previous update are read and diffed,
+ * all heights of any other matrix are
+ * @param MATRIX matrix
+ * @param side side of the matrix
+ * @param comparisonOnly flag indicating that only comparison line data should be updated
+ */
+void GridMesh::update( const HeightMatrix & MATRIX,
+                       COMPARISON_SIDE side,
+                       bool comparisonOnly )
+{
+    if ( MATRIX.getWidth() == 0 )
+    {
+        return;
+    }
+    layoutChanged = false;
+    changedHeights.clear();
+    if ( !comparisonOnly )
+    {
+        if ( MATRIX.getWidth() != matrixWidth || MATRIX.getHeight() != matrixHeight || MATRIX.getPrecision() != matrixPrecision ||
+             matrixGridEnabled != layoutHasMatrixGrid )
+        {
+            updateLayout(MATRIX);
+        }
+        allHeightsChanged = layoutChanged || MATRIX.getId() != matrixId;
+        matrixId = MATRIX.getId();
+        if (matrixGridEnabled)
+        {
+            updateMatrixGridHeights(MATRIX);
+            if ( layoutChanged || !changedHeights.empty() )
+            {
+                updateChunksHeights(MATRIX);
+            }
+        }
+    }
+    updateComparisonSideVertices( MATRIX, side );
+}
+
+/**
+ * @brief rebuilds flat grid and matrix mesh layout with indices, heights are reset to zero
+ * @param MATRIX matrix
+ */
+void GridMesh::updateLayout( const HeightMatrix & MATRIX )
+{
+    matrixWidth = MATRIX.getWidth();
+    matrixHeight = MATRIX.getHeight();
+    matrixPrecision = MATRIX.getPrecision();
+    layoutHasMatrixGrid = matrixGridEnabled;
+    width = matrixWidth * matrixPrecision;
+    height = matrixHeight * matrixPrecision;
+
+    layout.clear();
+    indices.clear();
+    chunks.clear();
+    chunksPerRow = 0;
+    flatGridVerticesCount = 0;
+    matrixGridVerticesCount = 0;
+    updateFlatGridLayout( matrixPrecision );
+    if (matrixGridEnabled)
+    {
+        updateMatrixGridLayout(MATRIX);
+    }
+
+    //every height is uploaded along with the new layout, so changed ranges are not tracked until the next update
+    heights.assign( flatGridVerticesCount + matrixGridVerticesCount, 0.0f );
+    layoutChanged = true;
+}
+
+/**
+ * @brief updates flat grid layout, flat grid always stays at zero height
+ * @param matrixPrecision precision of the matrix
+ */
+void GridMesh::updateFlatGridLayout( int matrixPrecision )
+{
+    int halfWidth = width / 2;
+    int halfHeight = height / 2;
+    auto bufferFlatGridVertex = [this]( float x, float z ) {
+        layout.emplace_back(x);
+        layout.emplace_back(z);
+        flatGridVerticesCount++;
+    };
+
+    //create lines parallel to X axis (count is equal to height of the grid plus one extra at z = 0.0)
+    for ( int z = -halfHeight; z <= halfHeight - matrixPrecision; z++ )
+    {
+        // (-X;z) and (X;z) vertices
+        bufferFlatGridVertex( (float)(-halfWidth), (float)z );
+        bufferFlatGridVertex( (float)(halfWidth - matrixPrecision), (float)z );
+    }
+
+    //create lines parallel to Z axis (count is equal to width of the grid plus one extra at x = 0.0)
+    for ( int x = -halfWidth; x <= halfWidth - matrixPrecision; x++ )
+    {
+        // (x;-Z) and (x;Z) vertices
+        bufferFlatGridVertex( (float)x, (float)(-halfHeight) );
+        bufferFlatGridVertex( (float)x, (float)(halfHeight - matrixPrecision) );
+    }
+}
+
+/**
+ * @brief updates matrix mesh layout: row strips in row-major order followed by column strips in column-major order.
+ * Both parts are presized and filled by disjoint blocks of lines in parallel.
+ * Indices are grouped by chunks, each chunk holds the parts of row and column strips crossing its cells
+ * @param MATRIX matrix
+ */
+void GridMesh::updateMatrixGridLayout( const HeightMatrix & MATRIX )
+{
+    const float HALF_WIDTH = (float)( width / 2 );
+    const float HALF_HEIGHT = (float)( height / 2 );
+    const float PRECISION = (float)MATRIX.getPrecision();
+    const size_t MATRIX_WIDTH = matrixWidth;
+    const size_t MATRIX_HEIGHT = matrixHeight;
+    const size_t CELLS = MATRIX_WIDTH * MATRIX_HEIGHT;
+
+    //(x;z) pair per vertex, one vertex per cell in row strips and one more in column strips
+    const size_t FIRST_FLOAT = layout.size();
+    layout.resize( FIRST_FLOAT + CELLS * 2 * 2 );
+    float * rowStrips = layout.data() + FIRST_FLOAT;
+    float * columnStrips = rowStrips + CELLS * 2;
+    matrixGridVerticesCount = (uint32_t)( CELLS * 2 );
+
+    const size_t ROWS_PER_JOB = linesPerJob(MATRIX_WIDTH);
+    const size_t ROW_JOBS = ( MATRIX_HEIGHT + ROWS_PER_JOB - 1 ) / ROWS_PER_JOB;
+    const size_t COLUMNS_PER_JOB = linesPerJob(MATRIX_HEIGHT);
+    const size_t COLUMN_JOBS = ( MATRIX_WIDTH + COLUMNS_PER_JOB - 1 ) / COLUMNS_PER_JOB;
+    parallelFor( ROW_JOBS + COLUMN_JOBS, [&]( size_t job ) {
+        if ( job < ROW_JOBS )
+        {
+            //line strips parallel to X axis (count is equal to height of the grid plus one extra at z = 0.0)
+            size_t lastRow = std::min( MATRIX_HEIGHT, ( job + 1 ) * ROWS_PER_JOB );
+            for ( size_t rowIndex = job * ROWS_PER_JOB; rowIndex < lastRow; rowIndex++ )
+            {
+                float z = rowIndex * PRECISION - HALF_HEIGHT;
+                float * vertex = rowStrips + rowIndex * MATRIX_WIDTH * 2;
+                for ( size_t columnIndex = 0; columnIndex < MATRIX_WIDTH; columnIndex++ )
+                {
+                    *vertex++ = columnIndex * PRECISION - HALF_WIDTH;
+                    *vertex++ = z;
+                }
+            }
+            return;
+        }
+        //line strips parallel to Z axis (count is equal to width of the grid plus one extra at x = 0.0)
+        size_t columnJob = job - ROW_JOBS;
+        size_t lastColumn = std::min( MATRIX_WIDTH, ( columnJob + 1 ) * COLUMNS_PER_JOB );
+        for ( size_t columnIndex = columnJob * COLUMNS_PER_JOB; columnIndex < lastColumn; columnIndex++ )
+        {
+            float x = columnIndex * PRECISION - HALF_WIDTH;
+            float * vertex = columnStrips + columnIndex * MATRIX_HEIGHT * 2;
+            for ( size_t rowIndex = 0; rowIndex < MATRIX_HEIGHT; rowIndex++ )
+            {
+                *vertex++ = x;
+                *vertex++ = rowIndex * PRECISION - HALF_HEIGHT;
+            }
+        }
+    } );
+
+    updateChunksLayout(MATRIX);
+}
+
+/**
+ * @brief splits matrix mesh into chunks of CHUNK_SIZE x CHUNK_SIZE cells and builds their indices and horizontal bounds.
+ * Strips of a chunk reach the first row and column of the neighbour chunks, so that adjacent chunks stay connected.
+ * Index ranges of the chunks are known from their dimensions, so chunks are filled in parallel
+ * @param MATRIX matrix
+ */
+void GridMesh::updateChunksLayout( const HeightMatrix & MATRIX )
+{
+    const float HALF_WIDTH = (float)( width / 2 );
+    const float HALF_HEIGHT = (float)( height / 2 );
+    const float PRECISION = (float)MATRIX.getPrecision();
+    const size_t MATRIX_WIDTH = matrixWidth;
+    const size_t MATRIX_HEIGHT = matrixHeight;
+    const uint32_t ROW_STRIPS_FIRST_VERTEX = flatGridVerticesCount;
+    const uint32_t COLUMN_STRIPS_FIRST_VERTEX = flatGridVerticesCount + (uint32_t)( MATRIX_WIDTH * MATRIX_HEIGHT );
+    chunksPerRow = ( MATRIX_WIDTH + CHUNK_SIZE - 1 ) / CHUNK_SIZE;
+    const size_t CHUNKS_PER_ROW = chunksPerRow;
+    const size_t CHUNKS_PER_COLUMN = ( MATRIX_HEIGHT + CHUNK_SIZE - 1 ) / CHUNK_SIZE;
+
+    //bounds first, row strips with the restart index and then column strips with the restart index give index count
+    chunks.resize( CHUNKS_PER_ROW * CHUNKS_PER_COLUMN );
+    size_t indexCount = 0;
+    for ( size_t chunkIndex = 0; chunkIndex < chunks.size(); chunkIndex++ )
+    {
+        size_t firstRow = chunkIndex / CHUNKS_PER_ROW * CHUNK_SIZE;
+        size_t firstColumn = chunkIndex % CHUNKS_PER_ROW * CHUNK_SIZE;
+        size_t lastRow = std::min( firstRow + CHUNK_SIZE, MATRIX_HEIGHT - 1 );
+        size_t lastColumn = std::min( firstColumn + CHUNK_SIZE, MATRIX_WIDTH - 1 );
+        size_t rowStrips = std::min( CHUNK_SIZE, MATRIX_HEIGHT - firstRow );
+        size_t columnStrips = std::min( CHUNK_SIZE, MATRIX_WIDTH - firstColumn );
+        Chunk & chunk = chunks[chunkIndex];
+        chunk.firstIndex = indexCount;
+        chunk.indexCount = rowStrips * ( lastColumn - firstColumn + 2 ) + columnStrips * ( lastRow - firstRow + 2 );
+        chunk.minX = firstColumn * PRECISION - HALF_WIDTH;
+        chunk.maxX = lastColumn * PRECISION - HALF_WIDTH;
+        chunk.minZ = firstRow * PRECISION - HALF_HEIGHT;
+        chunk.maxZ = lastRow * PRECISION - HALF_HEIGHT;
+        chunk.minY = 0.0f;
+        chunk.maxY = 0.0f;
+        indexCount += chunk.indexCount;
+    }
+    indices.resize(indexCount);
+
+    parallelFor( chunks.size(), [&]( size_t chunkIndex ) {
+        size_t firstRow = chunkIndex / CHUNKS_PER_ROW * CHUNK_SIZE;
+        size_t firstColumn = chunkIndex % CHUNKS_PER_ROW * CHUNK_SIZE;
+        size_t lastRow = std::min( firstRow + CHUNK_SIZE, MATRIX_HEIGHT - 1 );
+        size_t lastColumn = std::min( firstColumn + CHUNK_SIZE, MATRIX_WIDTH - 1 );
+        uint32_t * index = indices.data() + chunks[chunkIndex].firstIndex;
+        for ( size_t rowIndex = firstRow; rowIndex < std::min( firstRow + CHUNK_SIZE, MATRIX_HEIGHT ); rowIndex++ )
+        {
+            for ( size_t columnIndex = firstColumn; columnIndex <= lastColumn; columnIndex++ )
+            {
+                *index++ = ROW_STRIPS_FIRST_VERTEX + (uint32_t)( rowIndex * MATRIX_WIDTH + columnIndex );
+            }
+            *index++ = PRIMITIVE_RESTART_INDEX;
+        }
+        for ( size_t columnIndex = firstColumn; columnIndex < std::min( firstColumn + CHUNK_SIZE, MATRIX_WIDTH ); columnIndex++ )
+        {
+            for ( size_t rowIndex = firstRow; rowIndex <= lastRow; rowIndex++ )
+            {
+                *index++ = COLUMN_STRIPS_FIRST_VERTEX + (uint32_t)( columnIndex * MATRIX_HEIGHT + rowIndex );
+            }
+            *index++ = PRIMITIVE_RESTART_INDEX;
+        }
+    } );
+}
+
+/**
+ * @brief updates vertical bounds of the chunks from the matrix heights, overlapping row and column are included.
+ * All chunks are updated after the layout has been rebuilt, otherwise only chunks overlapping dirty rectangles.
+ * Chunks are independent, so they are updated in parallel
+ * @param MATRIX matrix of the same dimensions as the layout
+ */
+void GridMesh::updateChunksHeights( const HeightMatrix & MATRIX )
+{
+    const size_t MATRIX_WIDTH = matrixWidth;
+    const size_t MATRIX_HEIGHT = matrixHeight;
+    const size_t CHUNKS_PER_ROW = chunksPerRow;
+    const size_t CHUNKS_PER_COLUMN = chunks.size() / CHUNKS_PER_ROW;
+    changedChunks.clear();
+    if (allHeightsChanged)
+    {
+        changedChunks.resize( chunks.size() );
+        std::iota( changedChunks.begin(), changedChunks.end(), (size_t)0 );
+    }
+    else
+    {
+        for ( const HeightMatrix::DirtyRect & RECT : MATRIX.getDirtyRects() )
+        {
+            //first row and column of a chunk also belong to the chunks before it
+            size_t firstChunkRow = ( RECT.row > 0 ? RECT.row - 1 : 0 ) / CHUNK_SIZE;
+            size_t lastChunkRow = std::min( ( RECT.row + RECT.height - 1 ) / CHUNK_SIZE, CHUNKS_PER_COLUMN - 1 );
+            size_t firstChunkColumn = ( RECT.column > 0 ? RECT.column - 1 : 0 ) / CHUNK_SIZE;
+            size_t lastChunkColumn = std::min( ( RECT.column + RECT.width - 1 ) / CHUNK_SIZE, CHUNKS_PER_ROW - 1 );
+            for ( size_t chunkRow = firstChunkRow; chunkRow <= lastChunkRow; chunkRow++ )
+            {
+                for ( size_t chunkColumn = firstChunkColumn; chunkColumn <= lastChunkColumn; chunkColumn++ )
+                {
+                    changedChunks.push_back( chunkRow * CHUNKS_PER_ROW + chunkColumn );
+                }
+            }
+        }
+        std::sort( changedChunks.begin(), changedChunks.end() );
+        changedChunks.erase( std::unique( changedChunks.begin(), changedChunks.end() ), changedChunks.end() );
+    }
+
+    parallelFor( changedChunks.size(), [&]( size_t job ) {
+        size_t chunkIndex = changedChunks[job];
+        size_t firstRow = chunkIndex / CHUNKS_PER_ROW * CHUNK_SIZE;
+        size_t firstColumn = chunkIndex % CHUNKS_PER_ROW * CHUNK_SIZE;
+        size_t lastRow = std::min( firstRow + CHUNK_SIZE, MATRIX_HEIGHT - 1 );
+        size_t lastColumn = std::min( firstColumn + CHUNK_SIZE, MATRIX_WIDTH - 1 );
+        float minY = std::numeric_limits<float>::max();
+        float maxY = std::numeric_limits<float>::lowest();
+        for ( size_t rowIndex = firstRow; rowIndex <= lastRow; rowIndex++ )
+        {
+            HeightMatrix::ConstLineView row = MATRIX.row(rowIndex);
+            for ( size_t columnIndex = firstColumn; columnIndex <= lastColumn; columnIndex++ )
+            {
+                minY = std::min( minY, row[columnIndex] );
+                maxY = std::max( maxY, row[columnIndex] );
+            }
+        }
+        chunks[chunkIndex].minY = minY;
+        chunks[chunkIndex].maxY = maxY;
+    } );
+}
+
+/**
+ * @brief writes matrix heights to the heights stream and records ranges which differ from the previous update.
+ * All heights are written after the layout has been rebuilt and all are diffed for another matrix,
+ * otherwise only the dirty rectangles of the matrix are diffed
+ * @param MATRIX matrix of the same dimensions as the layout
+ */
+void GridMesh::updateMatrixGridHeights( const HeightMatrix & MATRIX )
+{
+    if (allHeightsChanged)
+    {
+        updateRegionHeights( MATRIX, HeightMatrix::DirtyRect{ 0, 0, matrixWidth, matrixHeight } );
+        return;
+    }
+    const std::vector<HeightMatrix::DirtyRect> & RECTS = MATRIX.getDirtyRects();
+    for ( const HeightMatrix::DirtyRect & RECT : RECTS )
+    {
+        updateRegionHeights( MATRIX, RECT );
+    }
+
+    //ranges of one region are in ascending order, ranges of several regions interleave and are sorted and merged again
+    if ( RECTS.size() > 1 && !changedHeights.empty() )
+    {
+        std::sort( changedHeights.begin(), changedHeights.end(), []( const HeightsRange & LEFT, const HeightsRange & RIGHT ) {
+            return LEFT.first < RIGHT.first;
+        } );
+        size_t merged = 0;
+        for ( size_t index = 1; index < changedHeights.size(); index++ )
+        {
+            HeightsRange & last = changedHeights[merged];
+            const HeightsRange & RANGE = changedHeights[index];
+            if ( RANGE.first <= last.first + last.count + CHANGED_RANGES_MERGE_GAP )
+            {
+                last.count = std::max( last.first + last.count, RANGE.first + RANGE.count ) - last.first;
+            }
+            else
+            {
+                changedHeights[++merged] = RANGE;
+            }
+        }
+        changedHeights.resize( merged + 1 );
+    }
+}
+
+/**
+ * @brief writes heights of a matrix region to the row and column strips crossing it and appends ranges which differ
+ * from the previous update. Blocks of row and column strips are diffed in parallel, each into its own ranges,
+ * which are merged in order afterwards
+ * @param MATRIX matrix of the same dimensions as the layout
+ * @param REGION cells to write
+ */
+void GridMesh::updateRegionHeights( const HeightMatrix & MATRIX,
+                                    const HeightMatrix::DirtyRect & REGION )
+{
+    const size_t MATRIX_WIDTH = matrixWidth;
+    const size_t MATRIX_HEIGHT = matrixHeight;
+    const size_t ROW_STRIPS_FIRST_VERTEX = flatGridVerticesCount;
+    const size_t COLUMN_STRIPS_FIRST_VERTEX = flatGridVerticesCount + MATRIX_WIDTH * MATRIX_HEIGHT;
+    const bool LAYOUT_CHANGED = layoutChanged;
+    auto storeHeight = [this, LAYOUT_CHANGED]( std::vector<HeightsRange> & ranges, size_t vertexIndex, float value ) {
+        if ( LAYOUT_CHANGED )
+        {
+            heights[vertexIndex] = value;
+            return;
+        }
+        if ( heights[vertexIndex] == value )
+        {
+            return;
+        }
+        heights[vertexIndex] = value;
+        if ( !ranges.empty() &&
+             vertexIndex <= ranges.back().first + ranges.back().count + CHANGED_RANGES_MERGE_GAP )
+        {
+            ranges.back().count = vertexIndex + 1 - ranges.back().first;
+        }
+        else
+        {
+            ranges.push_back( HeightsRange{ vertexIndex, 1 } );
+        }
+    };
+
+    const size_t FIRST_ROW = REGION.row;
+    const size_t LAST_ROW = REGION.row + REGION.height;
+    const size_t FIRST_COLUMN = REGION.column;
+    const size_t LAST_COLUMN = REGION.column + REGION.width;
+    const size_t ROWS_PER_JOB = linesPerJob(REGION.width);
+    const size_t ROW_JOBS = ( REGION.height + ROWS_PER_JOB - 1 ) / ROWS_PER_JOB;
+    const size_t COLUMNS_PER_JOB = linesPerJob(REGION.height);
+    const size_t COLUMN_JOBS = ( REGION.width + COLUMNS_PER_JOB - 1 ) / COLUMNS_PER_JOB;
+    if ( jobsChangedHeights.size() < ROW_JOBS + COLUMN_JOBS )
+    {
+        jobsChangedHeights.resize( ROW_JOBS + COLUMN_JOBS );
+    }
+    parallelFor( ROW_JOBS + COLUMN_JOBS, [&]( size_t job ) {
+        std::vector<HeightsRange> & ranges = jobsChangedHeights[job];
+        ranges.clear();
+        if ( job < ROW_JOBS )
+        {
+            //row strips follow the matrix memory layout
+            size_t lastRow = std::min( LAST_ROW, FIRST_ROW + ( job + 1 ) * ROWS_PER_JOB );
+            for ( size_t rowIndex = FIRST_ROW + job * ROWS_PER_JOB; rowIndex < lastRow; rowIndex++ )
+            {
+                HeightMatrix::ConstLineView row = MATRIX.row(rowIndex);
+                size_t vertexIndex = ROW_STRIPS_FIRST_VERTEX + rowIndex * MATRIX_WIDTH + FIRST_COLUMN;
+                for ( size_t columnIndex = FIRST_COLUMN; columnIndex < LAST_COLUMN; columnIndex++ )
+                {
+                    storeHeight( ranges, vertexIndex++, row[columnIndex] );
+                }
+            }
+            return;
+        }
+        //column strips
+        size_t columnJob = job - ROW_JOBS;
+        size_t lastColumn = std::min( LAST_COLUMN, FIRST_COLUMN + ( columnJob + 1 ) * COLUMNS_PER_JOB );
+        for ( size_t columnIndex = FIRST_COLUMN + columnJob * COLUMNS_PER_JOB; columnIndex < lastColumn; columnIndex++ )
+        {
+            HeightMatrix::ConstLineView column = MATRIX.column(columnIndex);
+            size_t vertexIndex = COLUMN_STRIPS_FIRST_VERTEX + columnIndex * MATRIX_HEIGHT + FIRST_ROW;
+            for ( size_t rowIndex = FIRST_ROW; rowIndex < LAST_ROW; rowIndex++ )
+            {
+                storeHeight( ranges, vertexIndex++, column[rowIndex] );
+            }
+        }
+    } );
+
+    //jobs cover ascending vertex ranges, so merging their ranges in job order gives the same ranges as a serial pass
+    for ( size_t job = 0; job < ROW_JOBS + COLUMN_JOBS; job++ )
+    {
+        for ( const HeightsRange & RANGE : jobsChangedHeights[job] )
+        {
+            if ( !changedHeights.empty() &&
+                 RANGE.first >= changedHeights.back().first &&
+                 RANGE.first <= changedHeights.back().first + changedHeights.back().count + CHANGED_RANGES_MERGE_GAP )
+            {
+                HeightsRange & last = changedHeights.back();
+                last.count = std::max( last.first + last.count, RANGE.first + RANGE.count ) - last.first;
+            }
+            else
+            {
+                changedHeights.push_back(RANGE);
+            }
+        }
+    }
+}
+
+/**
+ * @brief updates comparison side vertices storage
+ * @param MATRIX matrix
+ * @param side side of the matrix
+ */
+void GridMesh::updateComparisonSideVertices( const HeightMatrix & MATRIX,
+                                             COMPARISON_SIDE side )
+{
+    int halfWidth = width / 2;
+    int halfHeight = height / 2;
+    float precision = (float)MATRIX.getPrecision();
+    auto bufferComparisonSideVertex = [this]( MatrixGridVertex && sideVertex ) {
+        comparisonSideVertices.emplace_back( sideVertex.x );
+        comparisonSideVertices.emplace_back( sideVertex.y );
+        comparisonSideVertices.emplace_back( sideVertex.z );
+    };
+
+    const std::vector<float> & PROFILE = MATRIX.getEdgeProfile(side);
+    comparisonSideVertices.clear();
+    comparisonSideVertices.reserve( PROFILE.size() * 3 );
+    switch (side)
+    {
+    case COMPARISON_SIDE::LEFT:
+        for ( size_t index = 0; index < PROFILE.size(); index++ )
+        {
+            MatrixGridVertex v{ (float)(-halfWidth),
+                                PROFILE[index],
+                                index * precision - halfHeight };
+            bufferComparisonSideVertex( std::move(v) );
+        }
+        break;
+    case COMPARISON_SIDE::RIGHT:
+        for ( size_t index = 0; index < PROFILE.size(); index++ )
+        {
+            MatrixGridVertex v{ (float)halfWidth - precision,
+                                PROFILE[index],
+                                index * precision - halfHeight };
+            bufferComparisonSideVertex( std::move(v) );
+        }
+        break;
+    case COMPARISON_SIDE::TOP:
+        for ( size_t index = 0; index < PROFILE.size(); index++ )
+        {
+            MatrixGridVertex v{ index * precision - halfWidth,
+                                PROFILE[index],
+                                (float)(-halfHeight) };
+            bufferComparisonSideVertex( std::move(v) );
+        }
+        break;
+    case COMPARISON_SIDE::BOTTOM:
+        for ( size_t index = 0; index < PROFILE.size(); index++ )
+        {
+            MatrixGridVertex v{ index * precision - halfWidth,
+                                PROFILE[index],
+                                (float)halfHeight - precision };
+            bufferComparisonSideVertex( std::move(v) );
+        }
+        break;
+    }
+}
+
+
+//-------getters-------------
+
+/**
+ * @brief (x;z) pairs of flat grid and matrix mesh vertices
+ */
+const std::vector<float> & GridMesh::getLayout() const
+{
+    return layout;
+}
+
+/**
+ * @brief height of every layout vertex
+ */
+const std::vector<float> & GridMesh::getHeights() const
+{
+    return heights;
+}
+
+/**
+ * @brief indices of matrix mesh line strips, grouped by chunks
+ */
+const std::vector<uint32_t> & GridMesh::getIndices() const
+{
+    return indices;
+}
+
+/**
+ * @brief chunks of matrix mesh in row-major order, empty when matrix mesh is disabled
+ */
+const std::vector<GridMesh::Chunk> & GridMesh::getChunks() const
+{
+    return chunks;
+}
+
+/**
+ * @brief (x;y;z) triples of the comparison line
+ */
+const std::vector<float> & GridMesh::getComparisonSideVertices() const
+{
+    return comparisonSideVertices;
+}
+
+/**
+ * @brief whether the last update rebuilt layout and indices, all heights have to be uploaded then
+ */
+bool GridMesh::isLayoutChanged() const
+{
+    return layoutChanged;
+}
+
+/**
+ * @brief ranges of heights changed by the last update with the layout kept, in ascending order
+ */
+const std::vector<GridMesh::HeightsRange> & GridMesh::getChangedHeights() const
+{
+    return changedHeights;
+}
+
+int GridMesh::getWidth() const
+{
+    return width;
+}
+
+int GridMesh::getHeight() const
+{
+    return height;
+}
+
+uint32_t GridMesh::getFlatGridVerticesCount() const
+{
+    return flatGridVerticesCount;
+}
+
+uint32_t GridMesh::getMatrixGridVerticesCount() const
+{
+    return matrixGridVerticesCount;
+}
+
+uint32_t GridMesh::getComparisonSideVerticesCount() const
+{
+    return (uint32_t)( comparisonSideVertices.size() / 3 );
+}
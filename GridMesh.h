@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "HeightMatrix.h"
+
+/**
+ * @brief GUI-free vertex and index data of a matrix grid mesh, optional flat grid layer and comparison line.
+ * Grid data is split into a layout of (x;z) pairs with indices, which is rebuilt only when matrix dimensions or precision change,
+ * and a stream of heights, one per layout vertex, whose parts under the dirty rectangles of the matrix are diffed on every update
+ * so that only changed ranges have to be uploaded. A matrix other than the one of the previous update is diffed as a whole.
+ * Layout vertices are flat grid lines followed by matrix mesh line strips, indices address matrix mesh vertices only
+ * and separate line strips with the primitive restart index. Indices are grouped by square chunks with bounding boxes,
+ * so that a renderer draws only chunks in view. Comparison line is kept apart as (x;y;z) triples.
+ * Matrix mesh may be left out altogether when the matrix is rendered from a height texture
+ */
+class GridMesh
+{
+public:
+    //largest 32-bit index, so that it never collides with a vertex index of large matrices
+    constexpr static uint32_t PRIMITIVE_RESTART_INDEX = 0xFFFFFFFF;
+    //matrix mesh is split into chunks of that many cells per side, which are culled and drawn separately
+    constexpr static size_t CHUNK_SIZE = 64;
+
+    /**
+     * @brief Range of consecutive heights changed by the last update
+     */
+    struct HeightsRange
+    {
+        size_t first;
+        size_t count;
+    };
+
+    /**
+     * @brief Square part of matrix mesh: range of its indices and its axis-aligned bounding box
+     */
+    struct Chunk
+    {
+        size_t firstIndex;
+        size_t indexCount;
+        float minX, minY, minZ;
+        float maxX, maxY, maxZ;
+    };
+
+    GridMesh();
+    void setMatrixGridEnabled( bool enabled );
+    bool isMatrixGridEnabled() const;
+    void update( const HeightMatrix & MATRIX,
+                 COMPARISON_SIDE side,
+                 bool comparisonOnly = false );
+    const std::vector<float> & getLayout() const;
+    const std::vector<float> & getHeights() const;
+    const std::vector<uint32_t> & getIndices() const;
+    const std::vector<Chunk> & getChunks() const;
+    const std::vector<float> & getComparisonSideVertices() const;
+    bool isLayoutChanged() const;
+    const std::vector<HeightsRange> & getChangedHeights() const;
+    int getWidth() const;
+    int getHeight() const;
+    uint32_t getFlatGridVerticesCount() const;
+    uint32_t getMatrixGridVerticesCount() const;
+    uint32_t getComparisonSideVerticesCount() const;
+
+private:
+    struct MatrixGridVertex
+    {
+        float x, y, z;
+    };
+
+    void updateLayout( const HeightMatrix & MATRIX );
+    void updateFlatGridLayout( int matrixPrecision );
+    void updateMatrixGridLayout( const HeightMatrix & MATRIX );
+    void updateChunksLayout( const HeightMatrix & MATRIX );
+    void updateMatrixGridHeights( const HeightMatrix & MATRIX );
+    void updateRegionHeights( const HeightMatrix & MATRIX,
+                              const HeightMatrix::DirtyRect & REGION );
+    void updateChunksHeights( const HeightMatrix & MATRIX );
+    void updateComparisonSideVertices( const HeightMatrix & MATRIX,
+                                       COMPARISON_SIDE side );
+private:
+    std::vector<float> layout;
+    std::vector<float> heights;
+    std::vector<uint32_t> indices;
+    std::vector<Chunk> chunks;
+    std::vector<float> comparisonSideVertices;
+    std::vector<HeightsRange> changedHeights;
+    //changed ranges found by every parallel job, kept between updates to reuse their storage
+    std::vector<std::vector<HeightsRange>> jobsChangedHeights;
+    //chunks overlapping dirty rectangles, kept between updates to reuse their storage
+    std::vector<size_t> changedChunks;
+    bool layoutChanged;
+    //layout was rebuilt or the matrix is not the one of the previous update, so every height is read
+    bool allHeightsChanged;
+    bool matrixGridEnabled;
+    bool layoutHasMatrixGrid;
+    size_t matrixWidth;
+    size_t matrixHeight;
+    double matrixPrecision;
+    //id of the matrix of the previous update
+    uint64_t matrixId;
+    int width;
+    int height;
+    uint32_t flatGridVerticesCount;
+    uint32_t matrixGridVerticesCount;
+    size_t chunksPerRow;
+};
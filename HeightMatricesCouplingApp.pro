@@ -0,0 +1,69 @@
+QMAKE_EXTRA_TARGETS += before_build makefilehook
+makefilehook.target = $(MAKEFILE)
+makefilehook.depends = .beforebuild
+
+PRE_TARGETDEPS += .beforebuild
+before_build.target = .beforebuild
+before_build.depends = FORCE
+before_build.commands = chcp 1251
+
+QT += core gui opengl
+
+TARGET = HeightMatricesCoupling
+CONFIG += console
+CONFIG -= app_bundle
+
+include(common.pri)
+include(CouplingEngine.pri)
+
+# You can also make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+        AppWindow.cpp \
+        ArrangementWidget.cpp \
+        CameraBlock.cpp \
+        ComparisonSidesWidget.cpp \
+        CoordinateSystem.cpp \
+        FrameProfiler.cpp \
+        Grid.cpp \
+        MatrixWidget.cpp \
+        MosaicScene.cpp \
+        ShaderProgramCache.cpp \
+        StreamingBuffer.cpp \
+        TargetMatrixWidget.cpp \
+        UniformLocationCache.cpp \
+        main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+FORMS += \
+    AppWindow.ui
+
+HEADERS += \
+    AppWindow.h \
+    ArrangementWidget.h \
+    CameraBlock.h \
+    ComparisonSidesWidget.h \
+    CoordinateSystem.h \
+    FrameProfiler.h \
+    Grid.h \
+    MatrixWidget.h \
+    MosaicScene.h \
+    ShaderProgramCache.h \
+    StreamingBuffer.h \
+    TargetMatrixWidget.h \
+    UniformLocationCache.h
+
+RESOURCES += \
+    Shaders.qrc
+
+DISTFILES += \
+    README.md \
+    app.png \
+    todoList.txt
@@ -1,5 +1,22 @@
 #include "HeightMatrix.h"
 
+#include <algorithm>
+#include <cassert>
+
+#include "MappedFile.h"
+
+namespace
+{
+    //number of floats each row is padded to, so that every row starts on an aligned boundary
+    constexpr size_t ROW_ALIGNMENT_FLOATS = HeightMatrix::STORAGE_ALIGNMENT / sizeof(float);
+
+    uint64_t nextMatrixId()
+    {
+        static std::atomic<uint64_t> lastId( 0 );
+        return lastId.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    }
+}
+
 /**
  * @brief Utility function to convert an int value to SIDE enum value with bounds check
  * @param side int representation of a side
@@ -10,21 +27,120 @@ COMPARISON_SIDE HeightMatrix::sideFrom( int side )
     return side <= 3 ? COMPARISON_SIDE(side) : COMPARISON_SIDE::LEFT;
 }
 
+/**
+ * @brief calculates the side of an adjacent matrix that touches a given side
+ * @param side side of a matrix
+ * @return LEFT for RIGHT, TOP for BOTTOM and vice versa
+ */
+COMPARISON_SIDE HeightMatrix::oppositeSide( COMPARISON_SIDE side )
+{
+    switch (side)
+    {
+    case COMPARISON_SIDE::LEFT:
+        return COMPARISON_SIDE::RIGHT;
+    case COMPARISON_SIDE::RIGHT:
+        return COMPARISON_SIDE::LEFT;
+    case COMPARISON_SIDE::TOP:
+        return COMPARISON_SIDE::BOTTOM;
+    default:
+        return COMPARISON_SIDE::TOP;
+    }
+}
+
 HeightMatrix::HeightMatrix( size_t width,
                             size_t height,
                             double precision,
                             MATRIX_TYPE type )
     : width(width)
     , height(height)
+    , stride( ( width + ROW_ALIGNMENT_FLOATS - 1 ) / ROW_ALIGNMENT_FLOATS * ROW_ALIGNMENT_FLOATS )
     , precision(precision)
     , type(type)
+    , id( nextMatrixId() )
 {
-    //allocate data for storage
-    storage.resize(height);
-    for ( std::vector<float> & row : storage )
+    //allocate one contiguous block for all rows
+    storage.resize( stride * height );
+    values = storage.data();
+    markDirty( DirtyRect{ 0, 0, width, height }, false );
+}
+
+/**
+ * @brief constructs matrix on top of a mapped matrix file payload
+ * @param mapping mapped file, owned by the matrix from now on
+ * @param mappedValues first height of the payload inside the mapping
+ */
+HeightMatrix::HeightMatrix( std::unique_ptr<MappedFile> mapping,
+                            float * mappedValues,
+                            size_t width,
+                            size_t height,
+                            size_t stride,
+                            double precision,
+                            MATRIX_TYPE type )
+    : mapping( std::move(mapping) )
+    , values(mappedValues)
+    , width(width)
+    , height(height)
+    , stride(stride)
+    , precision(precision)
+    , type(type)
+    , id( nextMatrixId() )
+{
+    markDirty( DirtyRect{ 0, 0, width, height }, false );
+}
+
+/**
+ * @brief copies heights into an owned buffer, a copy of a mapped matrix is never mapped itself.
+ * Views have never seen the copy, so all of its cells are dirty
+ */
+HeightMatrix::HeightMatrix( const HeightMatrix & OTHER )
+    : storage( OTHER.values, OTHER.values + OTHER.stride * OTHER.height )
+    , values( storage.data() )
+    , width( OTHER.width )
+    , height( OTHER.height )
+    , stride( OTHER.stride )
+    , precision( OTHER.precision )
+    , type( OTHER.type )
+    , id( nextMatrixId() )
+{
+    markDirty( DirtyRect{ 0, 0, width, height }, false );
+}
+
+/**
+ * @brief takes over the buffer or the mapping of another matrix, which is left as an empty 0x0 matrix
+ */
+HeightMatrix::HeightMatrix( HeightMatrix && other ) noexcept
+    : values(nullptr)
+    , width(0)
+    , height(0)
+    , stride(0)
+    , precision( other.precision )
+    , type( other.type )
+    , id(0)
+{
+    takeOver(other);
+}
+
+HeightMatrix::~HeightMatrix() = default;
+
+HeightMatrix & HeightMatrix::operator=( const HeightMatrix & OTHER )
+{
+    if ( this != &OTHER )
     {
-        row.resize(width);
+        *this = HeightMatrix(OTHER);
     }
+    return *this;
+}
+
+/**
+ * @brief releases own heights and takes over the buffer or the mapping of another matrix, which is left as an empty 0x0 matrix
+ */
+HeightMatrix & HeightMatrix::operator=( HeightMatrix && other ) noexcept
+{
+    if ( this != &other )
+    {
+        takeOver(other);
+    }
+    return *this;
 }
 
 
@@ -50,24 +166,397 @@ HeightMatrix::MATRIX_TYPE HeightMatrix::getType() const
     return type;
 }
 
+/**
+ * @brief identifies the heights of a matrix: a constructed or copied matrix gets a new id, a moved matrix keeps it.
+ * Views which refresh only dirty rectangles compare it to tell whether they are given the matrix they have shown
+ */
+uint64_t HeightMatrix::getId() const
+{
+    return id;
+}
+
+/**
+ * @brief provides heights of a matrix edge as one contiguous array.
+ * The array is cached and gathered from the matrix again only after the edge may have been modified
+ * @param side side of the matrix
+ * @return heights of the first/last column for LEFT/RIGHT or the first/last row for TOP/BOTTOM
+ * @note reference stays valid until the matrix is destroyed or moved, its content is refreshed on the next call after modification.
+ * An edge with an open write is gathered on every call and is not cached until commitWrites()
+ */
+const std::vector<float> & HeightMatrix::getEdgeProfile( COMPARISON_SIDE side ) const
+{
+    size_t sideIndex = (size_t)side;
+    if ( edgeProfileValid[sideIndex].load(std::memory_order_acquire) )
+    {
+        return edgeProfiles[sideIndex];
+    }
+
+    //concurrent readers of a committed matrix rebuild the profile once, the others wait for it
+    std::lock_guard<std::mutex> lock(edgeProfilesMutex);
+    if ( !edgeProfileValid[sideIndex].load(std::memory_order_relaxed) )
+    {
+        ConstLineView line = edge(side);
+        edgeProfiles[sideIndex].assign( line.begin(), line.end() );
+        edgeProfileValid[sideIndex].store( !edgeWriteOpen[sideIndex], std::memory_order_release );
+    }
+    return edgeProfiles[sideIndex];
+}
+
+/**
+ * @brief rectangles of cells which may have been modified since the last clearDirtyRects(), none of them contains another.
+ * A new matrix or a copy is dirty as a whole
+ * @note cells are recorded when mutable access is handed out, writes through a view kept after clearDirtyRects() are missed
+ */
+const std::vector<HeightMatrix::DirtyRect> & HeightMatrix::getDirtyRects() const
+{
+    return dirtyRects;
+}
+
+/**
+ * @brief finds the part of an edge covered by dirty rectangles
+ * @param side side of the matrix
+ * @param first index of the first dirty height along the edge profile
+ * @param count number of heights from the first dirty one to the last one, clean heights in between included
+ * @return false if no height of the edge is dirty, first and count are left unchanged then
+ */
+bool HeightMatrix::getDirtyEdgeSpan( COMPARISON_SIDE side,
+                                     size_t & first,
+                                     size_t & count ) const
+{
+    bool dirty = false;
+    size_t last = 0;
+    for ( const DirtyRect & RECT : dirtyRects )
+    {
+        bool touches = false;
+        switch (side)
+        {
+        case COMPARISON_SIDE::LEFT:
+            touches = RECT.column == 0;
+            break;
+        case COMPARISON_SIDE::RIGHT:
+            touches = RECT.column + RECT.width == width;
+            break;
+        case COMPARISON_SIDE::TOP:
+            touches = RECT.row == 0;
+            break;
+        default:
+            touches = RECT.row + RECT.height == height;
+            break;
+        }
+        if ( !touches )
+        {
+            continue;
+        }
+        bool verticalSide = side == COMPARISON_SIDE::LEFT || side == COMPARISON_SIDE::RIGHT;
+        size_t rectFirst = verticalSide ? RECT.row : RECT.column;
+        size_t rectLast = rectFirst + ( verticalSide ? RECT.height : RECT.width ) - 1;
+        first = dirty ? std::min( first, rectFirst ) : rectFirst;
+        last = dirty ? std::max( last, rectLast ) : rectLast;
+        dirty = true;
+    }
+    if (dirty)
+    {
+        count = last + 1 - first;
+    }
+    return dirty;
+}
+
+/**
+ * @brief forgets dirty rectangles, called by the owner of the matrix after all of its views have been updated
+ */
+void HeightMatrix::clearDirtyRects()
+{
+    dirtyRects.clear();
+}
+
+/**
+ * @brief closes writes opened by mutable access, cached profiles are trusted again from now on.
+ * Called by the writer once no mutable view, iterator or data pointer handed out so far is written through any more,
+ * profiles of edges with an open write are gathered on every getEdgeProfile() call until then
+ */
+void HeightMatrix::commitWrites()
+{
+    std::fill( std::begin(edgeWriteOpen), std::end(edgeWriteOpen), false );
+}
+
+/**
+ * @brief records cells which may be modified and marks cached profiles of the edges they touch as outdated.
+ * Rectangles contained in others are dropped, adjacent ones are joined, too many rectangles are merged into their bounding rectangle
+ * @param rect cells to record, cut down to the matrix
+ * @param openWrite whether the cells are handed out for writing, which keeps profiles of the touched edges uncached until commitWrites()
+ */
+void HeightMatrix::markDirty( DirtyRect rect,
+                              bool openWrite )
+{
+    rect.width = std::min( rect.width, width - std::min( rect.column, width ) );
+    rect.height = std::min( rect.height, height - std::min( rect.row, height ) );
+    if ( rect.width == 0 || rect.height == 0 )
+    {
+        return;
+    }
+    const bool TOUCHED_EDGES[SIDES_COUNT] = { rect.column == 0, rect.column + rect.width == width,
+                                              rect.row == 0, rect.row + rect.height == height };
+    for ( size_t sideIndex = 0; sideIndex < SIDES_COUNT; sideIndex++ )
+    {
+        if ( TOUCHED_EDGES[sideIndex] )
+        {
+            edgeProfileValid[sideIndex].store( false, std::memory_order_relaxed );
+            edgeWriteOpen[sideIndex] |= openWrite;
+        }
+    }
+
+    auto contains = []( const DirtyRect & OUTER, const DirtyRect & INNER ) {
+        return INNER.column >= OUTER.column && INNER.column + INNER.width <= OUTER.column + OUTER.width &&
+               INNER.row >= OUTER.row && INNER.row + INNER.height <= OUTER.row + OUTER.height;
+    };
+    for ( const DirtyRect & EXISTING : dirtyRects )
+    {
+        if ( contains( EXISTING, rect ) )
+        {
+            return;
+        }
+    }
+    //rectangles spanning the same rows or columns which touch or overlap are joined, e.g. consecutively written lines
+    auto joins = []( const DirtyRect & FIRST, const DirtyRect & SECOND ) {
+        bool sameColumns = FIRST.column == SECOND.column && FIRST.width == SECOND.width;
+        bool sameRows = FIRST.row == SECOND.row && FIRST.height == SECOND.height;
+        return ( sameColumns && FIRST.row <= SECOND.row + SECOND.height && SECOND.row <= FIRST.row + FIRST.height ) ||
+               ( sameRows && FIRST.column <= SECOND.column + SECOND.width && SECOND.column <= FIRST.column + FIRST.width );
+    };
+    for ( size_t index = 0; index < dirtyRects.size(); )
+    {
+        const DirtyRect EXISTING = dirtyRects[index];
+        if ( !joins( EXISTING, rect ) )
+        {
+            index++;
+            continue;
+        }
+        size_t lastColumn = std::max( rect.column + rect.width, EXISTING.column + EXISTING.width );
+        size_t lastRow = std::max( rect.row + rect.height, EXISTING.row + EXISTING.height );
+        rect.column = std::min( rect.column, EXISTING.column );
+        rect.row = std::min( rect.row, EXISTING.row );
+        rect.width = lastColumn - rect.column;
+        rect.height = lastRow - rect.row;
+        dirtyRects.erase( dirtyRects.begin() + index );
+        index = 0;
+    }
+    dirtyRects.erase( std::remove_if( dirtyRects.begin(), dirtyRects.end(), [&]( const DirtyRect & EXISTING ) {
+        return contains( rect, EXISTING );
+    } ), dirtyRects.end() );
+    dirtyRects.push_back(rect);
+
+    if ( dirtyRects.size() > MAX_DIRTY_RECTS )
+    {
+        size_t lastColumn = 0;
+        size_t lastRow = 0;
+        for ( const DirtyRect & EXISTING : dirtyRects )
+        {
+            rect.column = std::min( rect.column, EXISTING.column );
+            rect.row = std::min( rect.row, EXISTING.row );
+            lastColumn = std::max( lastColumn, EXISTING.column + EXISTING.width );
+            lastRow = std::max( lastRow, EXISTING.row + EXISTING.height );
+        }
+        rect.width = lastColumn - rect.column;
+        rect.height = lastRow - rect.row;
+        dirtyRects.assign( 1, rect );
+    }
+}
+
+/**
+ * @brief moves heights, cached profiles and dirty rectangles of another matrix into this one.
+ * Moving a vector or a mapping keeps their addresses, so values pointer stays valid for the new owner,
+ * while the other matrix is reset to 0x0 so that it never reaches heights it no longer owns
+ * @param other matrix to take over from
+ */
+void HeightMatrix::takeOver( HeightMatrix & other ) noexcept
+{
+    storage = std::move( other.storage );
+    mapping = std::move( other.mapping );
+    values = other.values;
+    width = other.width;
+    height = other.height;
+    stride = other.stride;
+    precision = other.precision;
+    type = other.type;
+    id = other.id;
+    dirtyRects = std::move( other.dirtyRects );
+    for ( size_t sideIndex = 0; sideIndex < SIDES_COUNT; sideIndex++ )
+    {
+        edgeProfiles[sideIndex] = std::move( other.edgeProfiles[sideIndex] );
+        edgeProfileValid[sideIndex].store( other.edgeProfileValid[sideIndex].load(std::memory_order_relaxed), std::memory_order_relaxed );
+        edgeWriteOpen[sideIndex] = other.edgeWriteOpen[sideIndex];
+        other.edgeProfiles[sideIndex].clear();
+        other.edgeProfileValid[sideIndex].store( false, std::memory_order_relaxed );
+        other.edgeWriteOpen[sideIndex] = false;
+    }
+
+    other.storage.clear();
+    other.values = nullptr;
+    other.width = 0;
+    other.height = 0;
+    other.stride = 0;
+    other.id = nextMatrixId();
+    other.dirtyRects.clear();
+}
+
+/**
+ * @brief whether heights live in a mapped matrix file rather than in an owned buffer
+ */
+bool HeightMatrix::isMapped() const
+{
+    return mapping != nullptr;
+}
+
+/**
+ * @brief whether heights are mapped read-only, mutable access to such a matrix is not allowed
+ */
+bool HeightMatrix::isReadOnly() const
+{
+    return mapping != nullptr && mapping->getMode() == MappedFile::READ_ONLY;
+}
+
+/**
+ * @brief distance in floats between the starts of two adjacent rows
+ */
+size_t HeightMatrix::getStride() const
+{
+    return stride;
+}
+
+/**
+ * @brief mutable access to all heights, the whole matrix becomes dirty and writes to all edges are open until commitWrites()
+ */
+float * HeightMatrix::data()
+{
+    assert( !isReadOnly() );
+    markDirty( DirtyRect{ 0, 0, width, height }, true );
+    return values;
+}
+
+/**
+ * @brief mutable access to all heights for a bulk write confined to a region, only the region becomes dirty
+ * @param REGION cells the caller is going to modify, writes to the edges it touches are open until commitWrites()
+ * @note writes outside the region are not tracked
+ */
+float * HeightMatrix::data( const DirtyRect & REGION )
+{
+    assert( !isReadOnly() );
+    markDirty( REGION, true );
+    return values;
+}
+
+const float * HeightMatrix::data() const
+{
+    return values;
+}
+
+/**
+ * @brief mutable iterator over a row, marks the row dirty as row() does
+ */
 HeightMatrix::RowIterator HeightMatrix::rowBegin( const size_t ROW )
 {
-    return RowIterator( ROW, storage );
+    return RowIterator( row(ROW) );
 }
 
 HeightMatrix::ConstRowIterator HeightMatrix::rowBegin( const size_t ROW ) const
 {
-    return ConstRowIterator( ROW, storage );
+    return ConstRowIterator( row(ROW) );
 }
 
+/**
+ * @brief mutable iterator over a column, marks the column dirty as column() does
+ */
 HeightMatrix::ColumnIterator HeightMatrix::columnBegin( const size_t COLUMN )
 {
-    return ColumnIterator( COLUMN, storage );
+    return ColumnIterator( column(COLUMN) );
 }
 
 HeightMatrix::ConstColumnIterator HeightMatrix::columnBegin( const size_t COLUMN ) const
 {
-    return ConstColumnIterator( COLUMN, storage );
+    return ConstColumnIterator( column(COLUMN) );
+}
+
+
+//----HeightMatrix line views-----
+
+/**
+ * @brief mutable view of a row, the row becomes dirty and writes to the edges it crosses are open until commitWrites()
+ * @param ROW index of the row
+ */
+HeightMatrix::LineView HeightMatrix::row( const size_t ROW )
+{
+    assert( !isReadOnly() );
+
+    //a row crosses both side columns and may be the top or the bottom edge itself
+    markDirty( DirtyRect{ 0, ROW, width, 1 }, true );
+    return LineView( values + ROW * stride, width, 1 );
+}
+
+HeightMatrix::ConstLineView HeightMatrix::row( const size_t ROW ) const
+{
+    return ConstLineView( values + ROW * stride, width, 1 );
+}
+
+/**
+ * @brief mutable view of a column, the column becomes dirty and writes to the edges it crosses are open until commitWrites()
+ * @param COLUMN index of the column
+ */
+HeightMatrix::LineView HeightMatrix::column( const size_t COLUMN )
+{
+    assert( !isReadOnly() );
+
+    //a column crosses both side rows and may be the left or the right edge itself
+    markDirty( DirtyRect{ COLUMN, 0, 1, height }, true );
+    return LineView( values + COLUMN, height, stride );
+}
+
+HeightMatrix::ConstLineView HeightMatrix::column( const size_t COLUMN ) const
+{
+    return ConstLineView( values + COLUMN, height, stride );
+}
+
+/**
+ * @brief creates a view of the outermost line of the matrix for a given side
+ * @param side side of the matrix
+ * @return view of the first/last column for LEFT/RIGHT or the first/last row for TOP/BOTTOM, empty view for an empty matrix
+ * @note profile of the side is gathered on every getEdgeProfile() call until commitWrites(), so writes through the view are seen
+ */
+HeightMatrix::LineView HeightMatrix::edge( COMPARISON_SIDE side )
+{
+    if ( width == 0 || height == 0 )
+    {
+        return LineView( values, 0, 1 );
+    }
+    switch (side)
+    {
+    case COMPARISON_SIDE::LEFT:
+        return column(0);
+    case COMPARISON_SIDE::RIGHT:
+        return column( width - 1 );
+    case COMPARISON_SIDE::TOP:
+        return row(0);
+    default:
+        return row( height - 1 );
+    }
+}
+
+HeightMatrix::ConstLineView HeightMatrix::edge( COMPARISON_SIDE side ) const
+{
+    if ( width == 0 || height == 0 )
+    {
+        return ConstLineView( values, 0, 1 );
+    }
+    switch (side)
+    {
+    case COMPARISON_SIDE::LEFT:
+        return column(0);
+    case COMPARISON_SIDE::RIGHT:
+        return column( width - 1 );
+    case COMPARISON_SIDE::TOP:
+        return row(0);
+    default:
+        return row( height - 1 );
+    }
 }
 
 
@@ -78,7 +567,7 @@ HeightMatrix::Iterator::Iterator( size_t endIndex )
     , endIndex(endIndex)
 {}
 
-bool HeightMatrix::Iterator::isValid()
+bool HeightMatrix::Iterator::isValid() const
 {
     return currentIndex < endIndex;
 }
@@ -91,121 +580,169 @@ size_t HeightMatrix::Iterator::getCurrentIndex() const
 
 //----RowIterator definitions----
 
-HeightMatrix::RowIterator::RowIterator(const size_t ROW,
-                                        std::vector< std::vector<float> > & storage )
-    : Iterator( storage.at(ROW).size() )
-    , iter( storage.at(ROW).begin() )
+HeightMatrix::RowIterator::RowIterator( const LineView & ROW )
+    : Iterator( ROW.size() )
+    , iter( ROW.data() )
 {}
 
 float & HeightMatrix::RowIterator::operator*()
 {
+    assert( isValid() );
     return *iter;
 }
 
-float HeightMatrix::RowIterator::operator++(int)
+HeightMatrix::RowIterator & HeightMatrix::RowIterator::operator++()
 {
-    float prev = *iter;
     iter++;
     currentIndex++;
+    return *this;
+}
+
+HeightMatrix::RowIterator HeightMatrix::RowIterator::operator++(int)
+{
+    RowIterator prev = *this;
+    ++(*this);
     return prev;
 }
 
-float HeightMatrix::RowIterator::operator--(int)
+HeightMatrix::RowIterator & HeightMatrix::RowIterator::operator--()
 {
-    float prev = *iter;
     iter--;
     currentIndex--;
+    return *this;
+}
+
+HeightMatrix::RowIterator HeightMatrix::RowIterator::operator--(int)
+{
+    RowIterator prev = *this;
+    --(*this);
     return prev;
 }
 
 
 //----ConstRowIterator definitions----
 
-HeightMatrix::ConstRowIterator::ConstRowIterator(const size_t ROW,
-                                                  const std::vector< std::vector<float> > & STORAGE )
-    : Iterator( STORAGE.at(ROW).size() )
-    , iter( STORAGE.at(ROW).cbegin() )
+HeightMatrix::ConstRowIterator::ConstRowIterator( const ConstLineView & ROW )
+    : Iterator( ROW.size() )
+    , iter( ROW.data() )
 {}
 
 const float & HeightMatrix::ConstRowIterator::operator*() const
 {
+    assert( isValid() );
     return *iter;
 }
 
-float HeightMatrix::ConstRowIterator::operator++(int)
+HeightMatrix::ConstRowIterator & HeightMatrix::ConstRowIterator::operator++()
 {
-    float prev = *iter;
     iter++;
     currentIndex++;
+    return *this;
+}
+
+HeightMatrix::ConstRowIterator HeightMatrix::ConstRowIterator::operator++(int)
+{
+    ConstRowIterator prev = *this;
+    ++(*this);
     return prev;
 }
 
-float HeightMatrix::ConstRowIterator::operator--(int)
+HeightMatrix::ConstRowIterator & HeightMatrix::ConstRowIterator::operator--()
 {
-    float prev = *iter;
     iter--;
     currentIndex--;
+    return *this;
+}
+
+HeightMatrix::ConstRowIterator HeightMatrix::ConstRowIterator::operator--(int)
+{
+    ConstRowIterator prev = *this;
+    --(*this);
     return prev;
 }
 
 
 //----ColumnIterator definitions----
 
-HeightMatrix::ColumnIterator::ColumnIterator(const size_t COLUMN,
-                                              std::vector< std::vector<float> > & storage )
-    : Iterator( storage.size() )
-    , iter( storage.begin() )
-    , column(COLUMN)
+HeightMatrix::ColumnIterator::ColumnIterator( const LineView & COLUMN )
+    : Iterator( COLUMN.size() )
+    , iter( COLUMN.data() )
+    , stride( COLUMN.getStep() )
 {}
 
 float & HeightMatrix::ColumnIterator::operator*()
 {
-    return (*iter).at(column);
+    assert( isValid() );
+    return *iter;
 }
 
-float HeightMatrix::ColumnIterator::operator++(int)
+HeightMatrix::ColumnIterator & HeightMatrix::ColumnIterator::operator++()
 {
-    float prev = (*iter).at(column);
-    iter++;
+    iter += stride;
     currentIndex++;
+    return *this;
+}
+
+HeightMatrix::ColumnIterator HeightMatrix::ColumnIterator::operator++(int)
+{
+    ColumnIterator prev = *this;
+    ++(*this);
     return prev;
 }
 
-float HeightMatrix::ColumnIterator::operator--(int)
+HeightMatrix::ColumnIterator & HeightMatrix::ColumnIterator::operator--()
 {
-    float prev = (*iter).at(column);
-    iter--;
+    iter -= stride;
     currentIndex--;
+    return *this;
+}
+
+HeightMatrix::ColumnIterator HeightMatrix::ColumnIterator::operator--(int)
+{
+    ColumnIterator prev = *this;
+    --(*this);
     return prev;
 }
 
 
 //----ConstColumnIterator definitions----
 
-HeightMatrix::ConstColumnIterator::ConstColumnIterator(const size_t COLUMN,
-                                                        const std::vector< std::vector<float> > & STORAGE )
-    : Iterator( STORAGE.size() )
-    , iter( STORAGE.cbegin() )
-    , column(COLUMN)
+HeightMatrix::ConstColumnIterator::ConstColumnIterator( const ConstLineView & COLUMN )
+    : Iterator( COLUMN.size() )
+    , iter( COLUMN.data() )
+    , stride( COLUMN.getStep() )
 {}
 
 const float & HeightMatrix::ConstColumnIterator::operator*() const
 {
-    return (*iter).at(column);
+    assert( isValid() );
+    return *iter;
 }
 
-float HeightMatrix::ConstColumnIterator::operator++(int)
+HeightMatrix::ConstColumnIterator & HeightMatrix::ConstColumnIterator::operator++()
 {
-    float prev = (*iter).at(column);
-    iter++;
+    iter += stride;
     currentIndex++;
+    return *this;
+}
+
+HeightMatrix::ConstColumnIterator HeightMatrix::ConstColumnIterator::operator++(int)
+{
+    ConstColumnIterator prev = *this;
+    ++(*this);
     return prev;
 }
 
-float HeightMatrix::ConstColumnIterator::operator--(int)
+HeightMatrix::ConstColumnIterator & HeightMatrix::ConstColumnIterator::operator--()
 {
-    float prev = (*iter).at(column);
-    iter--;
+    iter -= stride;
     currentIndex--;
+    return *this;
+}
+
+HeightMatrix::ConstColumnIterator HeightMatrix::ConstColumnIterator::operator--(int)
+{
+    ConstColumnIterator prev = *this;
+    --(*this);
     return prev;
 }
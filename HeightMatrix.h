@@ -1,20 +1,42 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+#include "AlignedAllocator.h"
+#include "MatrixLine.h"
+
+class MappedFile;
+
 enum class COMPARISON_SIDE
 {
     LEFT, RIGHT, TOP, BOTTOM
 };
 
 /**
- * @brief Height matrix class represented by a 2D vector of height values.
- * matrix data is accessed via iterators
+ * @brief Height matrix class represented by a contiguous row-major buffer of height values.
+ * Each row starts at a multiple of the row stride, matrix data is accessed via iterators or line views.
+ * The buffer is either owned by the matrix or is a memory-mapped matrix file (see HeightMatrixFile).
+ * Heights of the four edges are additionally cached in contiguous profiles. Mutable access opens a write on the edges
+ * the accessed cells touch, profiles of such edges are gathered again on every getEdgeProfile() call, so heights written
+ * through a view which is still held are never missed. commitWrites() closes the writes once no view, iterator or data pointer
+ * handed out so far is written through any more, profiles are cached again from then on; engine writers commit their own writes.
+ * Every mutable access also records the cells it may modify as a dirty rectangle, so that views of the matrix
+ * refresh only what has changed; the owner of the matrix clears the rectangles once all views have been updated.
+ * Dirty rectangles describe changes of one matrix only, views compare matrix ids to tell another matrix of the same size from it
+ * @note const access from several threads at once is safe once writes are committed, profiles are cached under a lock
  */
 class HeightMatrix
 {
 public:
     constexpr static float MAX_HEIGHT = 2.0f;
+    //byte alignment of the storage and of every row start
+    constexpr static size_t STORAGE_ALIGNMENT = 64;
+    //more dirty rectangles than that are merged into their bounding rectangle
+    constexpr static size_t MAX_DIRTY_RECTS = 16;
 
     enum MATRIX_TYPE
     {
@@ -22,18 +44,34 @@ public:
     };
 
     static COMPARISON_SIDE sideFrom( int side );
+    static COMPARISON_SIDE oppositeSide( COMPARISON_SIDE side );
+
+    /**
+     * @brief Cells which may have been modified since the dirty rectangles were cleared last
+     */
+    struct DirtyRect
+    {
+        size_t column;
+        size_t row;
+        size_t width;
+        size_t height;
+    };
+
+    using LineView = MatrixLineView<float>;
+    using ConstLineView = MatrixLineView<const float>;
+    using LineIterator = MatrixLineIterator<float>;
+    using ConstLineIterator = MatrixLineIterator<const float>;
 
     /**
-     * @brief Base class for all types of matrix iterators
+     * @brief Base class for all types of matrix cursor iterators that know their own end
+     * @note for STL algorithms use line views and their random access iterators instead
      */
     class Iterator
     {
     public:
         Iterator( size_t endIndex );
-        bool isValid();
+        bool isValid() const;
         size_t getCurrentIndex() const;
-        virtual float operator++(int) = 0;
-        virtual float operator--(int) = 0;
 
     protected:
         size_t currentIndex;
@@ -44,58 +82,62 @@ public:
     class RowIterator : public Iterator
     {
     public:
-        RowIterator( const size_t ROW,
-                     std::vector< std::vector<float> > & storage );
+        RowIterator( const LineView & ROW );
         float & operator*();
-        float operator++(int) override;
-        float operator--(int) override;
+        RowIterator & operator++();
+        RowIterator operator++(int);
+        RowIterator & operator--();
+        RowIterator operator--(int);
 
     private:
-        std::vector<float>::iterator iter;
+        float * iter;
     };
 
     //ConstRowIterator declaration
     class ConstRowIterator : public Iterator
     {
     public:
-        ConstRowIterator( const size_t ROW,
-                          const std::vector< std::vector<float> > & STORAGE );
+        ConstRowIterator( const ConstLineView & ROW );
         const float & operator*() const;
-        float operator++(int) override;
-        float operator--(int) override;
+        ConstRowIterator & operator++();
+        ConstRowIterator operator++(int);
+        ConstRowIterator & operator--();
+        ConstRowIterator operator--(int);
 
     private:
-        std::vector<float>::const_iterator iter;
+        const float * iter;
     };
 
     //ColumnIterator declaration
     class ColumnIterator : public Iterator
     {
     public:
-        ColumnIterator( const size_t COLUMN,
-                        std::vector< std::vector<float> > & storage );
+        ColumnIterator( const LineView & COLUMN );
         float & operator*();
-        float operator++(int) override;
-        float operator--(int) override;
+        ColumnIterator & operator++();
+        ColumnIterator operator++(int);
+        ColumnIterator & operator--();
+        ColumnIterator operator--(int);
 
     private:
-        std::vector< std::vector<float> >::iterator iter;
-        size_t column;
+        float * iter;
+        size_t stride;
     };
 
     //ConstColumnIterator declaration
     class ConstColumnIterator : public Iterator
     {
     public:
-        ConstColumnIterator( const size_t COLUMN,
-                             const std::vector< std::vector<float> > & STORAGE );
+        ConstColumnIterator( const ConstLineView & COLUMN );
         const float & operator*() const;
-        float operator++(int) override;
-        float operator--(int) override;
+        ConstColumnIterator & operator++();
+        ConstColumnIterator operator++(int);
+        ConstColumnIterator & operator--();
+        ConstColumnIterator operator--(int);
 
     private:
-        std::vector< std::vector<float> >::const_iterator iter;
-        size_t column;
+        const float * iter;
+        size_t stride;
     };
 
 public:
@@ -103,19 +145,72 @@ public:
                   size_t height,
                   double precision,
                   MATRIX_TYPE type );
+    HeightMatrix( const HeightMatrix & OTHER );
+    HeightMatrix( HeightMatrix && other ) noexcept;
+    ~HeightMatrix();
+    HeightMatrix & operator=( const HeightMatrix & OTHER );
+    HeightMatrix & operator=( HeightMatrix && other ) noexcept;
     RowIterator rowBegin( const size_t ROW );
     ConstRowIterator rowBegin( const size_t ROW ) const;
     ColumnIterator columnBegin( const size_t COLUMN );
     ConstColumnIterator columnBegin( const size_t COLUMN ) const;
+    LineView row( const size_t ROW );
+    ConstLineView row( const size_t ROW ) const;
+    LineView column( const size_t COLUMN );
+    ConstLineView column( const size_t COLUMN ) const;
+    LineView edge( COMPARISON_SIDE side );
+    ConstLineView edge( COMPARISON_SIDE side ) const;
+    float * data();
+    float * data( const DirtyRect & REGION );
+    const float * data() const;
+    size_t getStride() const;
     size_t getWidth() const;
     size_t getHeight() const;
     double getPrecision() const;
     MATRIX_TYPE getType() const;
+    uint64_t getId() const;
+    const std::vector<float> & getEdgeProfile( COMPARISON_SIDE side ) const;
+    bool isMapped() const;
+    bool isReadOnly() const;
+    const std::vector<DirtyRect> & getDirtyRects() const;
+    bool getDirtyEdgeSpan( COMPARISON_SIDE side,
+                           size_t & first,
+                           size_t & count ) const;
+    void clearDirtyRects();
+    void commitWrites();
+
+private:
+    friend class HeightMatrixFile;
+    HeightMatrix( std::unique_ptr<MappedFile> mapping,
+                  float * mappedValues,
+                  size_t width,
+                  size_t height,
+                  size_t stride,
+                  double precision,
+                  MATRIX_TYPE type );
+    void markDirty( DirtyRect rect,
+                    bool openWrite );
+    void takeOver( HeightMatrix & other ) noexcept;
 
 private:
-    std::vector< std::vector<float> > storage;
+    constexpr static size_t SIDES_COUNT = 4;
+
+    std::vector< float, AlignedAllocator<float, STORAGE_ALIGNMENT> > storage;
+    std::unique_ptr<MappedFile> mapping;
+    //either points to storage or into the mapped file
+    float * values;
     size_t width;
     size_t height;
+    size_t stride;
     double precision;
     MATRIX_TYPE type;
+    //unique per constructed or copied matrix, moves carry it over along with the heights and dirty rectangles
+    uint64_t id;
+    //contiguous copies of the edges indexed by COMPARISON_SIDE, rebuilt by const readers under the lock
+    mutable std::vector<float> edgeProfiles[SIDES_COUNT];
+    mutable std::atomic<bool> edgeProfileValid[SIDES_COUNT] = {};
+    mutable std::mutex edgeProfilesMutex;
+    //edges which mutable access handed out since the last commitWrites() may still write
+    bool edgeWriteOpen[SIDES_COUNT] = { false, false, false, false };
+    std::vector<DirtyRect> dirtyRects;
 };
@@ -0,0 +1,281 @@
+#include "HeightMatrixFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr char MAGIC[8] = { 'H', 'M', 'A', 'T', 'R', 'I', 'X', '\0' };
+    //rows up to a page long put every page of the payload under a column anyway,
+    //so their column edges are read in blocks of whole rows instead of one value per row
+    constexpr uint64_t SHORT_ROW_BYTES = 4096;
+    constexpr uint64_t COLUMN_READ_BLOCK_BYTES = 64 * 1024;
+    static_assert( sizeof(HeightMatrixFileHeader) == 56, "height matrix file header must have a fixed layout" );
+}
+
+/**
+ * @brief writes matrix header and heights to a file, existing file is overwritten
+ * @param MATRIX matrix to save
+ * @param path path to the file
+ * @return true if the whole matrix has been written
+ */
+bool HeightMatrixFile::save( const HeightMatrix & MATRIX,
+                             const std::string & path )
+{
+    std::ofstream file( path, std::ios::binary | std::ios::trunc );
+    if ( !file )
+    {
+        return false;
+    }
+
+    HeightMatrixFileHeader header;
+    std::memcpy( header.magic, MAGIC, sizeof(MAGIC) );
+    header.version = VERSION;
+    header.type = (uint32_t)MATRIX.getType();
+    header.width = MATRIX.getWidth();
+    header.height = MATRIX.getHeight();
+    header.stride = MATRIX.getStride();
+    header.precision = MATRIX.getPrecision();
+    header.dataOffset = PAYLOAD_ALIGNMENT;
+
+    //header padded up to the payload offset
+    std::vector<char> headerBlock( header.dataOffset, 0 );
+    std::memcpy( headerBlock.data(), &header, sizeof(header) );
+    file.write( headerBlock.data(), headerBlock.size() );
+
+    //rows are stored with their padding, so the payload is one contiguous block
+    file.write( reinterpret_cast<const char*>( MATRIX.data() ), MATRIX.getStride() * MATRIX.getHeight() * sizeof(float) );
+    return (bool)file;
+}
+
+/**
+ * @brief makes matrix a zero-copy view of a mapped file
+ * @param path path to the file
+ * @param mode READ_ONLY - matrix must not be modified, COPY_ON_WRITE - modified pages are private to the matrix
+ * @param matrix matrix to replace
+ * @return false if the file could not be mapped or is not a valid height matrix file, matrix is left unchanged then
+ */
+bool HeightMatrixFile::map( const std::string & path,
+                            MappedFile::MAPPING_MODE mode,
+                            HeightMatrix & matrix )
+{
+    std::unique_ptr<MappedFile> mapping( new MappedFile );
+    if ( !mapping->open( path, mode ) || mapping->size() < sizeof(HeightMatrixFileHeader) )
+    {
+        return false;
+    }
+
+    HeightMatrixFileHeader header;
+    std::memcpy( &header, mapping->data(), sizeof(header) );
+    if ( !isValidHeader( header, mapping->size() ) )
+    {
+        return false;
+    }
+
+    float * values = reinterpret_cast<float*>( mapping->data() + header.dataOffset );
+    matrix = HeightMatrix( std::move(mapping), values,
+                           header.width, header.height, header.stride,
+                           header.precision, HeightMatrix::MATRIX_TYPE(header.type) );
+    return true;
+}
+
+/**
+ * @brief reads and validates header of a height matrix file without touching its payload
+ * @param path path to the file
+ * @param header header to fill
+ * @return true if the file starts with a valid header and is large enough to hold its payload
+ */
+bool HeightMatrixFile::readHeader( const std::string & path,
+                                   HeightMatrixFileHeader & header )
+{
+    std::ifstream file( path, std::ios::binary | std::ios::ate );
+    if ( !file )
+    {
+        return false;
+    }
+    uint64_t fileSize = (uint64_t)file.tellg();
+    file.seekg(0);
+    if ( !file.read( reinterpret_cast<char*>(&header), sizeof(header) ) )
+    {
+        return false;
+    }
+    return isValidHeader( header, fileSize );
+}
+
+/**
+ * @brief checks header fields for consistency
+ * @param HEADER header to check
+ * @param fileSize size of the whole file in bytes
+ */
+bool HeightMatrixFile::isValidHeader( const HeightMatrixFileHeader & HEADER,
+                                      uint64_t fileSize )
+{
+    constexpr uint64_t ROW_ALIGNMENT_FLOATS = HeightMatrix::STORAGE_ALIGNMENT / sizeof(float);
+    return std::memcmp( HEADER.magic, MAGIC, sizeof(MAGIC) ) == 0
+           && HEADER.version == VERSION
+           && ( HEADER.type == HeightMatrix::MASTER || HEADER.type == HeightMatrix::TARGET )
+           && HEADER.precision > 0.0
+           && HEADER.stride >= HEADER.width
+           && HEADER.stride % ROW_ALIGNMENT_FLOATS == 0
+           && HEADER.dataOffset >= sizeof(HeightMatrixFileHeader)
+           && HEADER.dataOffset % HeightMatrix::STORAGE_ALIGNMENT == 0
+           && fileSize >= HEADER.dataOffset
+           && ( HEADER.height == 0 || HEADER.stride <= ( fileSize - HEADER.dataOffset ) / sizeof(float) / HEADER.height );
+}
+
+/**
+ * @brief reads one edge of a matrix file without loading the rest of the payload.
+ * Row edges are read at once, column edges either in blocks of short rows or with one strided read per row
+ * @param path path to the file
+ * @param side side of the matrix
+ * @param header header of the file, filled on success
+ * @param edge storage for heights of the edge
+ * @return false if the file is not a valid height matrix file, is empty or could not be read
+ */
+bool HeightMatrixFile::readEdge( const std::string & path,
+                                 COMPARISON_SIDE side,
+                                 HeightMatrixFileHeader & header,
+                                 std::vector<float> & edge )
+{
+    uint64_t firstOffset, count, step;
+    if ( !readHeader( path, header ) || !edgeLocation( header, side, firstOffset, count, step ) )
+    {
+        return false;
+    }
+    std::ifstream file( path, std::ios::binary );
+    if ( !file )
+    {
+        return false;
+    }
+    edge.resize(count);
+
+    //row edge - one contiguous read
+    if ( step == sizeof(float) )
+    {
+        file.seekg( (std::streamoff)firstOffset );
+        return (bool)file.read( reinterpret_cast<char*>( edge.data() ), count * sizeof(float) );
+    }
+
+    //column edge of short rows - read several whole rows at once and pick the column out of them
+    if ( step <= SHORT_ROW_BYTES )
+    {
+        uint64_t rowsPerBlock = COLUMN_READ_BLOCK_BYTES / step;
+        uint64_t rowFloats = step / sizeof(float);
+        uint64_t columnIndex = ( firstOffset - header.dataOffset ) / sizeof(float);
+        std::vector<float> block( rowsPerBlock * rowFloats );
+        file.seekg( (std::streamoff)header.dataOffset );
+        for ( uint64_t row = 0; row < count; row += rowsPerBlock )
+        {
+            uint64_t blockRows = std::min( rowsPerBlock, count - row );
+            if ( !file.read( reinterpret_cast<char*>( block.data() ), blockRows * step ) )
+            {
+                return false;
+            }
+            for ( uint64_t blockRow = 0; blockRow < blockRows; blockRow++ )
+            {
+                edge[row + blockRow] = block[blockRow * rowFloats + columnIndex];
+            }
+        }
+        return true;
+    }
+
+    //column edge of long rows - one value per row
+    for ( uint64_t row = 0; row < count; row++ )
+    {
+        file.seekg( (std::streamoff)( firstOffset + row * step ) );
+        if ( !file.read( reinterpret_cast<char*>( &edge[row] ), sizeof(float) ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief overwrites one edge of a matrix file in place, the rest of the file is left untouched
+ * @param path path to the file
+ * @param side side of the matrix
+ * @param EDGE heights of the edge, must have exactly the edge length
+ * @return false if the file is not a valid height matrix file, edge length does not match or the file could not be written
+ */
+bool HeightMatrixFile::writeEdge( const std::string & path,
+                                  COMPARISON_SIDE side,
+                                  const std::vector<float> & EDGE )
+{
+    HeightMatrixFileHeader header;
+    uint64_t firstOffset, count, step;
+    if ( !readHeader( path, header ) || !edgeLocation( header, side, firstOffset, count, step ) || EDGE.size() != count )
+    {
+        return false;
+    }
+    std::fstream file( path, std::ios::binary | std::ios::in | std::ios::out );
+    if ( !file )
+    {
+        return false;
+    }
+
+    if ( step == sizeof(float) )
+    {
+        file.seekp( (std::streamoff)firstOffset );
+        file.write( reinterpret_cast<const char*>( EDGE.data() ), count * sizeof(float) );
+    }
+    else
+    {
+        for ( uint64_t row = 0; row < count && file; row++ )
+        {
+            file.seekp( (std::streamoff)( firstOffset + row * step ) );
+            file.write( reinterpret_cast<const char*>( &EDGE[row] ), sizeof(float) );
+        }
+    }
+    file.flush();
+    return (bool)file;
+}
+
+/**
+ * @brief calculates where heights of an edge are placed in a file
+ * @param HEADER valid header of the file
+ * @param side side of the matrix
+ * @param firstOffset byte offset of the first height of the edge
+ * @param count number of heights in the edge
+ * @param step distance in bytes between adjacent heights of the edge
+ * @return false for an empty matrix
+ */
+bool HeightMatrixFile::edgeLocation( const HeightMatrixFileHeader & HEADER,
+                                     COMPARISON_SIDE side,
+                                     uint64_t & firstOffset,
+                                     uint64_t & count,
+                                     uint64_t & step )
+{
+    if ( HEADER.width == 0 || HEADER.height == 0 )
+    {
+        return false;
+    }
+    uint64_t rowBytes = HEADER.stride * sizeof(float);
+    switch (side)
+    {
+    case COMPARISON_SIDE::LEFT:
+        firstOffset = HEADER.dataOffset;
+        count = HEADER.height;
+        step = rowBytes;
+        break;
+    case COMPARISON_SIDE::RIGHT:
+        firstOffset = HEADER.dataOffset + ( HEADER.width - 1 ) * sizeof(float);
+        count = HEADER.height;
+        step = rowBytes;
+        break;
+    case COMPARISON_SIDE::TOP:
+        firstOffset = HEADER.dataOffset;
+        count = HEADER.width;
+        step = sizeof(float);
+        break;
+    case COMPARISON_SIDE::BOTTOM:
+        firstOffset = HEADER.dataOffset + ( HEADER.height - 1 ) * rowBytes;
+        count = HEADER.width;
+        step = sizeof(float);
+        break;
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "HeightMatrix.h"
+#include "MappedFile.h"
+
+/**
+ * @brief Fixed-size header at the start of a binary height matrix file.
+ * The header is followed by padding up to dataOffset and then by height rows of stride floats each,
+ * so the payload has exactly the in-memory layout of HeightMatrix and can be mapped without copying.
+ * All fields and heights are stored in the native byte order of the writing host,
+ * a file written on a host of the other byte order fails the version check
+ */
+struct HeightMatrixFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t type;
+    uint64_t width;
+    uint64_t height;
+    uint64_t stride;
+    double precision;
+    uint64_t dataOffset;
+};
+
+/**
+ * @brief Reading and writing of height matrices in the binary file format.
+ * Besides whole-matrix access a single edge may be read or written in place, with I/O proportional to the edge length
+ */
+class HeightMatrixFile
+{
+public:
+    constexpr static uint32_t VERSION = 1;
+    //payload starts on a page boundary, which also satisfies HeightMatrix storage alignment
+    constexpr static uint64_t PAYLOAD_ALIGNMENT = 4096;
+
+    static bool save( const HeightMatrix & MATRIX,
+                      const std::string & path );
+    static bool map( const std::string & path,
+                     MappedFile::MAPPING_MODE mode,
+                     HeightMatrix & matrix );
+    static bool readHeader( const std::string & path,
+                            HeightMatrixFileHeader & header );
+    static bool isValidHeader( const HeightMatrixFileHeader & HEADER,
+                               uint64_t fileSize );
+    static bool readEdge( const std::string & path,
+                          COMPARISON_SIDE side,
+                          HeightMatrixFileHeader & header,
+                          std::vector<float> & edge );
+    static bool writeEdge( const std::string & path,
+                           COMPARISON_SIDE side,
+                           const std::vector<float> & EDGE );
+
+private:
+    static bool edgeLocation( const HeightMatrixFileHeader & HEADER,
+                              COMPARISON_SIDE side,
+                              uint64_t & firstOffset,
+                              uint64_t & count,
+                              uint64_t & step );
+};
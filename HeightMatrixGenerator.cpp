@@ -0,0 +1,187 @@
+#include "HeightMatrixGenerator.h"
+
+#include <algorithm>
+
+#include "CpuFeatures.h"
+#include "ParallelFor.h"
+
+#ifdef COUPLING_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    //rows are grouped into jobs of at least that many cells, so small matrices are not spread over threads at all
+    constexpr size_t MIN_CELLS_PER_JOB = 16 * 1024;
+    //hash keeps 24 bits, which are converted to float exactly and scaled to the heights range
+    constexpr float HEIGHT_SCALE = HeightMatrix::MAX_HEIGHT / 16777216.0f;
+
+    /**
+     * @brief 64-bit finalizer of splitmix64, used once per row to derive the row key
+     */
+    inline uint64_t mix64( uint64_t value )
+    {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ull;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBull;
+        value ^= value >> 31;
+        return value;
+    }
+
+    inline uint64_t rowKey( uint64_t seed,
+                            size_t row )
+    {
+        return mix64( mix64(seed) ^ ( (uint64_t)row * 0x9E3779B97F4A7C15ull ) );
+    }
+
+    /**
+     * @brief 32-bit integer hash with only shifts, xors and 32-bit multiplications, so that it maps directly onto vector instructions
+     */
+    inline uint32_t mix32( uint32_t value )
+    {
+        value ^= value >> 16;
+        value *= 0x7FEB352Du;
+        value ^= value >> 15;
+        value *= 0x846CA68Bu;
+        value ^= value >> 16;
+        return value;
+    }
+
+    inline float cellHeight( uint32_t rowKeyLow,
+                             uint32_t rowKeyHigh,
+                             uint32_t column )
+    {
+        uint32_t hash = mix32( mix32( column + rowKeyLow ) ^ rowKeyHigh );
+        return (float)(int32_t)( hash >> 8 ) * HEIGHT_SCALE;
+    }
+
+    void generateScalar( uint32_t rowKeyLow,
+                         uint32_t rowKeyHigh,
+                         size_t columns,
+                         float * output )
+    {
+        for ( size_t column = 0; column < columns; column++ )
+        {
+            output[column] = cellHeight( rowKeyLow, rowKeyHigh, (uint32_t)column );
+        }
+    }
+
+#ifdef COUPLING_X86_SIMD
+    COUPLING_TARGET_AVX2
+    inline __m256i mix32Avx2( __m256i value )
+    {
+        value = _mm256_xor_si256( value, _mm256_srli_epi32( value, 16 ) );
+        value = _mm256_mullo_epi32( value, _mm256_set1_epi32( (int)0x7FEB352Du ) );
+        value = _mm256_xor_si256( value, _mm256_srli_epi32( value, 15 ) );
+        value = _mm256_mullo_epi32( value, _mm256_set1_epi32( (int)0x846CA68Bu ) );
+        value = _mm256_xor_si256( value, _mm256_srli_epi32( value, 16 ) );
+        return value;
+    }
+
+    COUPLING_TARGET_AVX2
+    void generateAvx2( uint32_t rowKeyLow,
+                       uint32_t rowKeyHigh,
+                       size_t columns,
+                       float * output )
+    {
+        //8 columns per iteration, same operations as the scalar hash, so both paths give identical heights
+        const __m256i KEY_LOW = _mm256_set1_epi32( (int)rowKeyLow );
+        const __m256i KEY_HIGH = _mm256_set1_epi32( (int)rowKeyHigh );
+        const __m256 SCALE = _mm256_set1_ps(HEIGHT_SCALE);
+        const __m256i STEP = _mm256_set1_epi32(8);
+        __m256i columnIndices = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+        size_t column = 0;
+        for ( ; column + 8 <= columns; column += 8 )
+        {
+            __m256i hash = mix32Avx2( _mm256_add_epi32( columnIndices, KEY_LOW ) );
+            hash = mix32Avx2( _mm256_xor_si256( hash, KEY_HIGH ) );
+            __m256 heights = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_srli_epi32( hash, 8 ) ), SCALE );
+            _mm256_storeu_ps( output + column, heights );
+            columnIndices = _mm256_add_epi32( columnIndices, STEP );
+        }
+        for ( ; column < columns; column++ )
+        {
+            output[column] = cellHeight( rowKeyLow, rowKeyHigh, (uint32_t)column );
+        }
+    }
+#endif
+}
+
+/**
+ * @param seed seed of the generated heights
+ */
+HeightMatrixGenerator::HeightMatrixGenerator( uint64_t seed )
+    : seed(seed)
+    , kernel( selectKernel() )
+{}
+
+void HeightMatrixGenerator::setSeed( uint64_t seed )
+{
+    this->seed = seed;
+}
+
+uint64_t HeightMatrixGenerator::getSeed() const
+{
+    return seed;
+}
+
+/**
+ * @brief fills the whole matrix, rows are generated in parallel
+ * @param matrix matrix to fill, must not be read-only
+ * @param threadCount number of threads to use, 0 means one per hardware thread. Result does not depend on it
+ */
+void HeightMatrixGenerator::fill( HeightMatrix & matrix,
+                                  unsigned int threadCount ) const
+{
+    const size_t WIDTH = matrix.getWidth();
+    const size_t HEIGHT = matrix.getHeight();
+    if ( WIDTH == 0 || HEIGHT == 0 )
+    {
+        return;
+    }
+    float * values = matrix.data();
+    const size_t STRIDE = matrix.getStride();
+    const size_t ROWS_PER_JOB = std::max( (size_t)1, MIN_CELLS_PER_JOB / WIDTH );
+    const size_t JOBS = ( HEIGHT + ROWS_PER_JOB - 1 ) / ROWS_PER_JOB;
+    const uint64_t SEED = seed;
+    const Kernel KERNEL = kernel;
+
+    parallelFor( JOBS, [&]( size_t job ) {
+        size_t lastRow = std::min( HEIGHT, ( job + 1 ) * ROWS_PER_JOB );
+        for ( size_t row = job * ROWS_PER_JOB; row < lastRow; row++ )
+        {
+            uint64_t key = rowKey( SEED, row );
+            KERNEL( (uint32_t)key, (uint32_t)( key >> 32 ), WIDTH, values + row * STRIDE );
+        }
+    }, threadCount );
+    matrix.commitWrites();
+}
+
+/**
+ * @brief height generated for a single cell, equal to the one written by fill() with the same seed
+ * @param seed seed of the generated heights
+ * @param row row of the cell
+ * @param column column of the cell
+ */
+float HeightMatrixGenerator::heightAt( uint64_t seed,
+                                       size_t row,
+                                       size_t column )
+{
+    uint64_t key = rowKey( seed, row );
+    return cellHeight( (uint32_t)key, (uint32_t)( key >> 32 ), (uint32_t)column );
+}
+
+/**
+ * @brief picks the widest kernel supported by the current CPU
+ */
+HeightMatrixGenerator::Kernel HeightMatrixGenerator::selectKernel()
+{
+#ifdef COUPLING_X86_SIMD
+    if ( CpuFeatures::hasAvx2() )
+    {
+        return generateAvx2;
+    }
+#endif
+    return generateScalar;
+}
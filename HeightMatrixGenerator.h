@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "HeightMatrix.h"
+
+/**
+ * @brief Fills matrices with pseudo-random heights in [0; MAX_HEIGHT).
+ * Every height is a hash of (seed, row, column) rather than the next value of a sequential engine,
+ * so rows are generated independently in parallel and the result for a given seed does not depend on the number of threads
+ */
+class HeightMatrixGenerator
+{
+public:
+    explicit HeightMatrixGenerator( uint64_t seed = 0 );
+    void setSeed( uint64_t seed );
+    uint64_t getSeed() const;
+    void fill( HeightMatrix & matrix,
+               unsigned int threadCount = 0 ) const;
+    static float heightAt( uint64_t seed,
+                           size_t row,
+                           size_t column );
+
+    /**
+     * @brief Kernel writing heights of a number of consecutive columns of one row, starting from column 0
+     */
+    using Kernel = void (*)( uint32_t rowKeyLow,
+                             uint32_t rowKeyHigh,
+                             size_t columns,
+                             float * output );
+
+private:
+    static Kernel selectKernel();
+
+private:
+    uint64_t seed;
+    Kernel kernel;
+};
@@ -0,0 +1,146 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : address(nullptr)
+    , length(0)
+    , mode(READ_ONLY)
+#ifdef _WIN32
+    , fileHandle(INVALID_HANDLE_VALUE)
+    , mappingHandle(nullptr)
+#else
+    , fileDescriptor(-1)
+#endif
+{}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+/**
+ * @brief maps the whole file, previously mapped file is released first
+ * @param path path to the file
+ * @param mode whether pages are mapped read-only or copy-on-write
+ * @return true if the file has been mapped, false if it could not be opened, is empty or could not be mapped
+ */
+bool MappedFile::open( const std::string & path,
+                       MAPPING_MODE mode )
+{
+    close();
+    this->mode = mode;
+
+#ifdef _WIN32
+    fileHandle = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    if ( fileHandle == INVALID_HANDLE_VALUE )
+    {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if ( !GetFileSizeEx( fileHandle, &fileSize ) || fileSize.QuadPart == 0 )
+    {
+        close();
+        return false;
+    }
+    length = (size_t)fileSize.QuadPart;
+    mappingHandle = CreateFileMappingA( fileHandle, nullptr, mode == READ_ONLY ? PAGE_READONLY : PAGE_WRITECOPY, 0, 0, nullptr );
+    if ( mappingHandle == nullptr )
+    {
+        close();
+        return false;
+    }
+    address = MapViewOfFile( mappingHandle, mode == READ_ONLY ? FILE_MAP_READ : FILE_MAP_COPY, 0, 0, 0 );
+#else
+    fileDescriptor = ::open( path.c_str(), O_RDONLY );
+    if ( fileDescriptor < 0 )
+    {
+        return false;
+    }
+    struct stat fileStatus;
+    if ( fstat( fileDescriptor, &fileStatus ) != 0 || fileStatus.st_size == 0 )
+    {
+        close();
+        return false;
+    }
+    length = (size_t)fileStatus.st_size;
+    int protection = mode == READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+    address = mmap( nullptr, length, protection, MAP_PRIVATE, fileDescriptor, 0 );
+    if ( address == MAP_FAILED )
+    {
+        address = nullptr;
+    }
+#endif
+
+    if ( address == nullptr )
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief unmaps the file and releases its handles
+ */
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if ( address != nullptr )
+    {
+        UnmapViewOfFile(address);
+    }
+    if ( mappingHandle != nullptr )
+    {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if ( fileHandle != INVALID_HANDLE_VALUE )
+    {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if ( address != nullptr )
+    {
+        munmap( address, length );
+    }
+    if ( fileDescriptor >= 0 )
+    {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+    address = nullptr;
+    length = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+    return address != nullptr;
+}
+
+char * MappedFile::data() const
+{
+    return static_cast<char*>(address);
+}
+
+size_t MappedFile::size() const
+{
+    return length;
+}
+
+MappedFile::MAPPING_MODE MappedFile::getMode() const
+{
+    return mode;
+}
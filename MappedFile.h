@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief RAII wrapper of a whole file mapped into memory
+ */
+class MappedFile
+{
+public:
+    enum MAPPING_MODE
+    {
+        READ_ONLY,      //pages are shared with the file and must not be written
+        COPY_ON_WRITE   //written pages become private copies, the file is never modified
+    };
+
+    MappedFile();
+    ~MappedFile();
+    MappedFile( const MappedFile & ) = delete;
+    MappedFile & operator=( const MappedFile & ) = delete;
+    bool open( const std::string & path,
+               MAPPING_MODE mode );
+    void close();
+    bool isOpen() const;
+    char * data() const;
+    size_t size() const;
+    MAPPING_MODE getMode() const;
+
+private:
+    void * address;
+    size_t length;
+    MAPPING_MODE mode;
+#ifdef _WIN32
+    void * fileHandle;
+    void * mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
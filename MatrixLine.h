@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/**
+ * @brief Random access iterator over matrix elements placed at a constant step from each other.
+ * Step of 1 walks a row, step equal to the row stride walks a column
+ * @note no bounds checks are made unless assertions are enabled
+ */
+template<typename T>
+class MatrixLineIterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename std::remove_const<T>::type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    MatrixLineIterator()
+        : element(nullptr)
+        , step(1)
+    {}
+
+    MatrixLineIterator( T * element,
+                        difference_type step )
+        : element(element)
+        , step(step)
+    {}
+
+    //allows implicit conversion of a mutable iterator to a const one
+    template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+    MatrixLineIterator( const MatrixLineIterator<U> & OTHER )
+        : element( OTHER.base() )
+        , step( OTHER.getStep() )
+    {}
+
+    reference operator*() const
+    {
+        return *element;
+    }
+    pointer operator->() const
+    {
+        return element;
+    }
+    reference operator[]( difference_type offset ) const
+    {
+        return element[offset * step];
+    }
+
+    MatrixLineIterator & operator++()
+    {
+        element += step;
+        return *this;
+    }
+    MatrixLineIterator operator++(int)
+    {
+        MatrixLineIterator prev = *this;
+        element += step;
+        return prev;
+    }
+    MatrixLineIterator & operator--()
+    {
+        element -= step;
+        return *this;
+    }
+    MatrixLineIterator operator--(int)
+    {
+        MatrixLineIterator prev = *this;
+        element -= step;
+        return prev;
+    }
+    MatrixLineIterator & operator+=( difference_type offset )
+    {
+        element += offset * step;
+        return *this;
+    }
+    MatrixLineIterator & operator-=( difference_type offset )
+    {
+        element -= offset * step;
+        return *this;
+    }
+    MatrixLineIterator operator+( difference_type offset ) const
+    {
+        return MatrixLineIterator( element + offset * step, step );
+    }
+    friend MatrixLineIterator operator+( difference_type offset,
+                                         const MatrixLineIterator & ITER )
+    {
+        return ITER + offset;
+    }
+    MatrixLineIterator operator-( difference_type offset ) const
+    {
+        return MatrixLineIterator( element - offset * step, step );
+    }
+    difference_type operator-( const MatrixLineIterator & OTHER ) const
+    {
+        assert( step == OTHER.step );
+        return ( element - OTHER.element ) / step;
+    }
+
+    bool operator==( const MatrixLineIterator & OTHER ) const
+    {
+        return element == OTHER.element;
+    }
+    bool operator!=( const MatrixLineIterator & OTHER ) const
+    {
+        return element != OTHER.element;
+    }
+    bool operator<( const MatrixLineIterator & OTHER ) const
+    {
+        return element < OTHER.element;
+    }
+    bool operator>( const MatrixLineIterator & OTHER ) const
+    {
+        return element > OTHER.element;
+    }
+    bool operator<=( const MatrixLineIterator & OTHER ) const
+    {
+        return element <= OTHER.element;
+    }
+    bool operator>=( const MatrixLineIterator & OTHER ) const
+    {
+        return element >= OTHER.element;
+    }
+
+    T * base() const
+    {
+        return element;
+    }
+    difference_type getStep() const
+    {
+        return step;
+    }
+
+private:
+    T * element;
+    difference_type step;
+};
+
+/**
+ * @brief Non-owning view of a matrix line (row, column or edge) with a constant element step
+ */
+template<typename T>
+class MatrixLineView
+{
+public:
+    using iterator = MatrixLineIterator<T>;
+    using value_type = typename std::remove_const<T>::type;
+
+    MatrixLineView( T * first,
+                    size_t size,
+                    size_t step )
+        : first(first)
+        , count(size)
+        , step(step)
+    {}
+
+    //allows implicit conversion of a mutable view to a const one
+    template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+    MatrixLineView( const MatrixLineView<U> & OTHER )
+        : first( OTHER.data() )
+        , count( OTHER.size() )
+        , step( OTHER.getStep() )
+    {}
+
+    T & operator[]( size_t index ) const
+    {
+        assert( index < count );
+        return first[index * step];
+    }
+    iterator begin() const
+    {
+        return iterator( first, (std::ptrdiff_t)step );
+    }
+    iterator end() const
+    {
+        return iterator( first + count * step, (std::ptrdiff_t)step );
+    }
+    T * data() const
+    {
+        return first;
+    }
+    size_t size() const
+    {
+        return count;
+    }
+    size_t getStep() const
+    {
+        return step;
+    }
+    //whether elements are adjacent in memory, i.e. the view is a row
+    bool isContiguous() const
+    {
+        return step == 1;
+    }
+
+private:
+    T * first;
+    size_t count;
+    size_t step;
+};
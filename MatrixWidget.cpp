@@ -1,15 +1,42 @@
 #include "MatrixWidget.h"
 #include <QMouseEvent>
 #include <QMatrix4x4>
+#include <QDir>
+#include <QPainter>
+#include <algorithm>
+
+#include "ShaderProgramCache.h"
+
+namespace
+{
+    const QVector3D DEFAULT_EYE_POSITION( 20.0f, 20.0f, 20.0f );
+}
 
 MatrixWidget::MatrixWidget( QWidget * parent )
     : QOpenGLWidget(parent)
     , functions()
-    , eyePosition( 20, 20, 20 )
+    , sceneMode(false)
+    , eyePosition( DEFAULT_EYE_POSITION )
 {}
 
+MatrixWidget::~MatrixWidget()
+{
+    //GL objects and shared programs have to be released within the context
+    makeCurrent();
+    grid.reset();
+    scene.reset();
+    profiler.reset();
+    coordinateSystem.reset();
+    cameraBlock.reset();
+    gridShaderProgram.reset();
+    gridTextureShaderProgram.reset();
+    csShaderProgram.reset();
+    sceneShaderProgram.reset();
+    doneCurrent();
+}
+
 /**
- * @brief delegates update call to the widget's underlying grid object
+ * @brief delegates update call to the widget's underlying grid object, leaves mosaic scene mode
  * @param MATRIX matrix
  * @param side side of the matrix
  * @param comparisonOnly flag indicating that only comparison line data should be updated
@@ -18,9 +45,37 @@ void MatrixWidget::updateMatrixData( const HeightMatrix & MATRIX,
                                      COMPARISON_SIDE side,
                                      bool comparisonOnly )
 {
+    if (sceneMode)
+    {
+        sceneMode = false;
+        eyePosition = eyePosition.normalized() * DEFAULT_EYE_POSITION.length();
+    }
     grid->update( MATRIX, side, comparisonOnly );
 }
 
+/**
+ * @brief shows a mosaic of tiles instead of the matrix grid and moves the camera to see the whole mosaic
+ * @param TILES tiles in row-major order
+ * @param rows number of tile rows
+ * @param columns number of tile columns
+ * @return false if the mosaic could not be built, view is left unchanged then
+ */
+bool MatrixWidget::updateMosaicData( const std::vector<HeightMatrix> & TILES,
+                                     size_t rows,
+                                     size_t columns )
+{
+    makeCurrent();
+    if ( !scene->update( TILES, rows, columns ) )
+    {
+        return false;
+    }
+    sceneMode = true;
+    float distance = std::max( DEFAULT_EYE_POSITION.length(), std::max( scene->getWidth(), scene->getHeight() ) * 0.9f );
+    eyePosition = eyePosition.normalized() * distance;
+    update();
+    return true;
+}
+
 /**
  * @brief delegates flat grid visibility setter call to grid object
  * @param showGrid bool flag
@@ -32,6 +87,36 @@ void MatrixWidget::setShowFlatGrid( bool showGrid )
     update();
 }
 
+/**
+ * @brief enables per-stage CPU and GPU timings of the view, shown over it and logged to a JSON file in the temporary directory
+ * @param enabled whether timings are measured
+ */
+void MatrixWidget::setFrameTimingsEnabled( bool enabled )
+{
+    makeCurrent();
+    grid->setProfiler(nullptr);
+    profiler.reset();
+    if (enabled)
+    {
+        profiler = std::make_unique<FrameProfiler>(functions);
+        QString logPath = QDir::temp().filePath( objectName() + "_frames.json" );
+        profiler->setLogPath(logPath);
+        grid->setProfiler( profiler.get() );
+        qInfo( "Frame timings are logged to %s", qPrintable(logPath) );
+    }
+    update();
+}
+
+/**
+ * @brief switches grid between vertex mesh and height texture rendering, matrix data should be updated afterwards
+ * @param enabled true to render the matrix from a height texture
+ */
+void MatrixWidget::setHeightTextureMode( bool enabled )
+{
+    makeCurrent();
+    grid->setRenderMode( enabled ? Grid::HEIGHT_TEXTURE : Grid::VERTEX_MESH );
+}
+
 void MatrixWidget::mouseMoveEvent( QMouseEvent * event )
 {
     constexpr QVector3D Y_AXIS_VECTOR( 0.0, 1.0, 0.0 );
@@ -90,62 +175,86 @@ void MatrixWidget::initializeGL()
     functions.glEnable(GL_DEPTH_TEST);
     setClearColor();
 
-    //create shaders for grid mesh
-    QOpenGLShader vertexGridShader( QOpenGLShader::Vertex );
-    vertexGridShader.compileSourceFile( ":/Shaders/grid/vGrid.glsl" );
-    QOpenGLShader fragmentGridShader( QOpenGLShader::Fragment );
-    fragmentGridShader.compileSourceFile( ":/Shaders/grid/fGrid.glsl" );
-    //shader program
-    gridShaderProgram.addShader( &vertexGridShader );
-    gridShaderProgram.addShader( &fragmentGridShader );
-    if ( !gridShaderProgram.link() )
+    //programs are shared with the other widgets
+    gridShaderProgram = ShaderProgramCache::get( ShaderProgramCache::GRID );
+    gridTextureShaderProgram = ShaderProgramCache::get( ShaderProgramCache::GRID_TEXTURE );
+    csShaderProgram = ShaderProgramCache::get( ShaderProgramCache::COORDINATE_SYSTEM );
+    sceneShaderProgram = ShaderProgramCache::get( ShaderProgramCache::SCENE );
+
+    //initialize camera matrices storage, grid and coordinate system objects
+    cameraBlock = std::make_unique<CameraBlock>(functions);
+    grid = std::make_unique<Grid>( *gridShaderProgram, *gridTextureShaderProgram, functions );
+    scene = std::make_unique<MosaicScene>( *sceneShaderProgram, functions );
+    coordinateSystem = std::make_unique<CoordinateSystem>( *csShaderProgram, functions );
+}
+
+/**
+ * @brief draw function, constructs matrices delegates draw calls to grid and CS objects
+ */
+void MatrixWidget::paintGL()
+{
     {
-        qWarning("Unable to link grid shader program");
+        FrameProfiler::Scope frameScope( profiler.get(), FrameProfiler::FRAME );
+        drawFrame();
     }
-
-    //create shaders for coordinate system
-    QOpenGLShader vertexCsShader( QOpenGLShader::Vertex );
-    vertexCsShader.compileSourceFile( ":/Shaders/coordinateSystem/vCS.glsl" );
-    QOpenGLShader geometryCsShader( QOpenGLShader::Geometry );
-    geometryCsShader.compileSourceFile( ":/Shaders/coordinateSystem/gCS.glsl" );
-    QOpenGLShader fragmentCsShader( QOpenGLShader::Fragment );
-    fragmentCsShader.compileSourceFile( ":/Shaders/coordinateSystem/fCS.glsl" );
-    //shader program
-    csShaderProgram.addShader( &vertexCsShader );
-    csShaderProgram.addShader( &geometryCsShader );
-    csShaderProgram.addShader( &fragmentCsShader );
-    if ( !csShaderProgram.link() )
+    if (profiler)
     {
-        qWarning("Unable to link coordinate system shader program");
+        profiler->endFrame();
+        drawFrameTimings();
     }
-
-    //initialize grid and coordinate system objects
-    grid = std::make_unique<Grid>( gridShaderProgram, functions );
-    coordinateSystem = std::make_unique<CoordinateSystem>( csShaderProgram, functions );
 }
 
 /**
- * @brief draw function, constructs matrices delegates draw calls to grid and CS objects
+ * @brief draws the grid or the mosaic and the coordinate system
  */
-void MatrixWidget::paintGL()
+void MatrixWidget::drawFrame()
 {
+    //painter of the timings overlay leaves depth test disabled
+    functions.glEnable(GL_DEPTH_TEST);
     functions.glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
     //update projection matrix
     QMatrix4x4 projectionMatrix;
     const float FOV = 40.0f;
-    const float FAR_DISTANCE = 300.0f;
+    //far plane moves away with the camera, so a zoomed out mosaic is not clipped
+    const float FAR_DISTANCE = std::max( 300.0f, eyePosition.length() * 4.0f );
     projectionMatrix.perspective( FOV, (float)width() / (float)height(), 0.1f, FAR_DISTANCE );
 
     //update view matrix
     QMatrix4x4 viewMatrix;
     viewMatrix.lookAt( eyePosition, QVector3D( 0.0f, 0.0f, 0.0f ), QVector3D( 0.0f, 1.0f, 0.0f ) );
 
-    //grid rendering
-    grid->draw( projectionMatrix, viewMatrix );
+    //matrices are shared by all programs through the uniform block
+    cameraBlock->update( projectionMatrix, viewMatrix );
+
+    //grid or mosaic rendering
+    if (sceneMode)
+    {
+        FrameProfiler::Scope scope( profiler.get(), FrameProfiler::MESH_DRAW );
+        scene->draw();
+    }
+    else
+    {
+        grid->draw( projectionMatrix, viewMatrix );
+    }
 
     //coordinate system rendering
-    coordinateSystem->draw( projectionMatrix, viewMatrix );
+    FrameProfiler::Scope scope( profiler.get(), FrameProfiler::COORDINATE_SYSTEM_DRAW );
+    coordinateSystem->draw();
+}
+
+/**
+ * @brief paints average stage timings over the rendered frame
+ */
+void MatrixWidget::drawFrameTimings()
+{
+    QPainter painter(this);
+    QFont font = painter.font();
+    font.setFamily("monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    painter.drawText( rect().adjusted( 8, 8, -8, -8 ), Qt::AlignLeft | Qt::AlignTop, profiler->getOverlayText() );
 }
 
 /**
@@ -7,6 +7,9 @@
 #include "HeightMatrix.h"
 #include "Grid.h"
 #include "CoordinateSystem.h"
+#include "CameraBlock.h"
+#include "FrameProfiler.h"
+#include "MosaicScene.h"
 
 /**
  * @brief View widget of the matrix
@@ -16,12 +19,18 @@ class MatrixWidget : public QOpenGLWidget
     Q_OBJECT
 public:
     explicit MatrixWidget( QWidget * parent = 0 );
+    virtual ~MatrixWidget();
     void updateMatrixData( const HeightMatrix & MATRIX,
                            COMPARISON_SIDE side,
                            bool comparisonOnly = false );
+    bool updateMosaicData( const std::vector<HeightMatrix> & TILES,
+                           size_t rows,
+                           size_t columns );
 
 public slots:
     void setShowFlatGrid( bool showGrid );
+    void setHeightTextureMode( bool enabled );
+    void setFrameTimingsEnabled( bool enabled );
     void mouseMoveEvent( QMouseEvent * event ) override;
     void mousePressEvent( QMouseEvent * event ) override;
 
@@ -30,12 +39,21 @@ protected:
     void paintGL() override;
     void resizeGL( int w, int h ) override;
     virtual void setClearColor();
+    void drawFrame();
+    void drawFrameTimings();
 
     QOpenGLFunctions_4_3_Core functions;
-    QOpenGLShaderProgram gridShaderProgram;
-    QOpenGLShaderProgram csShaderProgram;
+    std::shared_ptr<QOpenGLShaderProgram> gridShaderProgram;
+    std::shared_ptr<QOpenGLShaderProgram> gridTextureShaderProgram;
+    std::shared_ptr<QOpenGLShaderProgram> csShaderProgram;
+    std::shared_ptr<QOpenGLShaderProgram> sceneShaderProgram;
+    std::unique_ptr<CameraBlock> cameraBlock;
     std::unique_ptr<Grid> grid;
     std::unique_ptr<CoordinateSystem> coordinateSystem;
+    std::unique_ptr<MosaicScene> scene;
+    std::unique_ptr<FrameProfiler> profiler;
+    //mosaic scene is drawn instead of the grid
+    bool sceneMode;
     QVector3D eyePosition;
     QPointF lastMousePosition;
 };
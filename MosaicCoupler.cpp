@@ -0,0 +1,134 @@
+#include "MosaicCoupler.h"
+
+#include <chrono>
+
+#include "CouplingEngine.h"
+#include "ParallelFor.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double millisecondsSince( Clock::time_point start )
+    {
+        return std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+    }
+}
+
+/**
+ * @param threadCount number of threads to couple edges with, 0 means one per hardware thread
+ */
+MosaicCoupler::MosaicCoupler( unsigned int threadCount )
+    : threadCount(threadCount)
+    , totalMilliseconds(0.0)
+{}
+
+/**
+ * @brief couples all shared edges of a mosaic.
+ * Edges are coupled in four phases: horizontal pairs with an even left column, with an odd left column,
+ * then vertical pairs with an even upper row and with an odd upper row. Within a phase every job touches
+ * its own two tiles only, so no two concurrent jobs write the same edge or corner or read a tile being written.
+ * The result does not depend on the number of threads
+ * @param tiles row-major storage of rows * columns tiles
+ * @param rows number of tile rows
+ * @param columns number of tile columns
+ */
+void MosaicCoupler::couple( std::vector<HeightMatrix> & tiles,
+                            size_t rows,
+                            size_t columns )
+{
+    Clock::time_point start = Clock::now();
+    tileTimings.clear();
+    if ( tiles.size() < rows * columns )
+    {
+        totalMilliseconds = 0.0;
+        return;
+    }
+    tileTimings.reserve( rows * columns );
+    for ( size_t row = 0; row < rows; row++ )
+    {
+        for ( size_t column = 0; column < columns; column++ )
+        {
+            tileTimings.push_back( TileTiming{ row, column, 0.0, 0, 0 } );
+        }
+    }
+
+    //horizontal pairs: right side of the left tile is the master of the left side of the right tile
+    for ( size_t parity = 0; parity < 2; parity++ )
+    {
+        std::vector<EdgeJob> jobs;
+        for ( size_t row = 0; row < rows; row++ )
+        {
+            for ( size_t column = parity; column + 1 < columns; column += 2 )
+            {
+                size_t tile = row * columns + column;
+                jobs.push_back( EdgeJob{ tile, tile + 1, COMPARISON_SIDE::RIGHT } );
+            }
+        }
+        runPhase( tiles, jobs );
+    }
+
+    //vertical pairs: bottom side of the upper tile is the master of the top side of the lower tile
+    for ( size_t parity = 0; parity < 2; parity++ )
+    {
+        std::vector<EdgeJob> jobs;
+        for ( size_t row = parity; row + 1 < rows; row += 2 )
+        {
+            for ( size_t column = 0; column < columns; column++ )
+            {
+                size_t tile = row * columns + column;
+                jobs.push_back( EdgeJob{ tile, tile + columns, COMPARISON_SIDE::BOTTOM } );
+            }
+        }
+        runPhase( tiles, jobs );
+    }
+
+    totalMilliseconds = millisecondsSince(start);
+}
+
+/**
+ * @brief per-tile statistics of the last coupling, row-major like the tiles
+ */
+const std::vector<MosaicCoupler::TileTiming> & MosaicCoupler::getTileTimings() const
+{
+    return tileTimings;
+}
+
+/**
+ * @brief wall time of the last coupling of the whole mosaic
+ */
+double MosaicCoupler::getTotalMilliseconds() const
+{
+    return totalMilliseconds;
+}
+
+/**
+ * @brief couples a set of independent edges in parallel
+ * @param tiles storage of the tiles
+ * @param JOBS edges that share no tile with each other
+ */
+void MosaicCoupler::runPhase( std::vector<HeightMatrix> & tiles,
+                              const std::vector<EdgeJob> & JOBS )
+{
+    parallelFor( JOBS.size(), [this, &tiles, &JOBS]( size_t jobIndex ) {
+        const EdgeJob & JOB = JOBS[jobIndex];
+        Clock::time_point start = Clock::now();
+        CouplingEngine engine;
+        bool coupled = engine.couple( tiles[JOB.masterTile],
+                                      tiles[JOB.targetTile],
+                                      JOB.masterSide,
+                                      HeightMatrix::oppositeSide(JOB.masterSide) );
+
+        //each target tile is written by one job of a phase only, so its statistics are not shared either
+        TileTiming & timing = tileTimings[JOB.targetTile];
+        timing.couplingMilliseconds += millisecondsSince(start);
+        if (coupled)
+        {
+            timing.coupledEdges++;
+        }
+        else
+        {
+            timing.skippedEdges++;
+        }
+    }, threadCount );
+}
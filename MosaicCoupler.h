@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+#include "HeightMatrix.h"
+
+/**
+ * @brief Couples every shared edge of a rows x columns arrangement of tiles in parallel.
+ * Left tile of a horizontal pair acts as the master of its right side, upper tile of a vertical pair as the master of its bottom side
+ */
+class MosaicCoupler
+{
+public:
+    /**
+     * @brief Coupling statistics of a single tile, all edges written into the tile are accounted to it
+     */
+    struct TileTiming
+    {
+        size_t row, column;
+        double couplingMilliseconds;
+        unsigned int coupledEdges;
+        unsigned int skippedEdges;
+    };
+
+    explicit MosaicCoupler( unsigned int threadCount = 0 );
+    void couple( std::vector<HeightMatrix> & tiles,
+                 size_t rows,
+                 size_t columns );
+    const std::vector<TileTiming> & getTileTimings() const;
+    double getTotalMilliseconds() const;
+
+private:
+    /**
+     * @brief Master and target tiles of one shared edge
+     */
+    struct EdgeJob
+    {
+        size_t masterTile, targetTile;
+        COMPARISON_SIDE masterSide;
+    };
+
+    void runPhase( std::vector<HeightMatrix> & tiles,
+                   const std::vector<EdgeJob> & JOBS );
+
+private:
+    unsigned int threadCount;
+    std::vector<TileTiming> tileTimings;
+    double totalMilliseconds;
+};
@@ -0,0 +1,133 @@
+#include "MosaicScene.h"
+
+#include <numeric>
+#include <QOpenGLShaderProgram>
+
+namespace
+{
+    //binding point of the TileOffsets storage block of the scene vertex shader
+    const GLuint TILE_OFFSETS_BINDING = 0;
+}
+
+MosaicScene::MosaicScene( QOpenGLShaderProgram & shaderProgram,
+                          QOpenGLFunctions_4_3_Core & functions )
+    : shaderProgram(shaderProgram)
+    , functions(functions)
+    , vertexBuffer( functions, GL_ARRAY_BUFFER, GL_STATIC_DRAW )
+    , tileIndexBuffer( functions, GL_ARRAY_BUFFER, GL_STATIC_DRAW )
+    , indexBuffer( functions, GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW )
+    , commandBuffer( functions, GL_DRAW_INDIRECT_BUFFER, GL_STATIC_DRAW )
+    , tileOffsetsBuffer( functions, GL_SHADER_STORAGE_BUFFER, GL_STATIC_DRAW )
+    , tilesCount(0)
+{
+    functions.glGenVertexArrays( 1, &vao );
+    functions.glBindVertexArray(vao);
+    vertexBuffer.bind();
+    functions.glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+    functions.glEnableVertexAttribArray(0);
+    //tile index advances per instance, so the base instance of a draw command selects the element holding its tile index
+    tileIndexBuffer.bind();
+    functions.glVertexAttribIPointer( 2, 1, GL_UNSIGNED_INT, 0, 0 );
+    functions.glVertexAttribDivisor( 2, 1 );
+    functions.glEnableVertexAttribArray(2);
+    indexBuffer.bind();
+    functions.glBindVertexArray(0);
+
+    functions.glEnable(GL_PRIMITIVE_RESTART);
+    functions.glPrimitiveRestartIndex(SceneMesh::PRIMITIVE_RESTART_INDEX);
+
+    uniforms.resolve(shaderProgram);
+}
+
+MosaicScene::~MosaicScene()
+{
+    functions.glDeleteVertexArrays( 1, &vao );
+}
+
+/**
+ * @brief rebuilds the scene and uploads all its buffers
+ * @param TILES tiles in row-major order
+ * @param rows number of tile rows
+ * @param columns number of tile columns
+ * @return false if the scene could not be built, it is left empty then
+ */
+bool MosaicScene::update( const std::vector<HeightMatrix> & TILES,
+                          size_t rows,
+                          size_t columns )
+{
+    if ( !mesh.build( TILES, rows, columns ) )
+    {
+        tilesCount = 0;
+        return false;
+    }
+    tilesCount = (GLsizei)TILES.size();
+
+    const std::vector<float> & VERTICES = mesh.getVertices();
+    const std::vector<uint32_t> & INDICES = mesh.getIndices();
+    const std::vector<SceneMesh::DrawCommand> & GRID_COMMANDS = mesh.getGridCommands();
+    const std::vector<SceneMesh::DrawCommand> & SEAM_COMMANDS = mesh.getSeamCommands();
+    const std::vector<SceneMesh::TileOffset> & TILE_OFFSETS = mesh.getTileOffsets();
+    std::vector<GLuint> tileIndices(tilesCount);
+    std::iota( tileIndices.begin(), tileIndices.end(), 0 );
+    std::vector<SceneMesh::DrawCommand> commands(GRID_COMMANDS);
+    commands.insert( commands.end(), SEAM_COMMANDS.begin(), SEAM_COMMANDS.end() );
+
+    //element buffer binding belongs to the vertex array object
+    functions.glBindVertexArray(vao);
+    vertexBuffer.assign( VERTICES.data(), VERTICES.size() * sizeof(float) );
+    tileIndexBuffer.assign( tileIndices.data(), tileIndices.size() * sizeof(GLuint) );
+    indexBuffer.assign( INDICES.data(), INDICES.size() * sizeof(GLuint) );
+    functions.glBindVertexArray(0);
+    commandBuffer.assign( commands.data(), commands.size() * sizeof(SceneMesh::DrawCommand) );
+    tileOffsetsBuffer.assign( TILE_OFFSETS.data(), TILE_OFFSETS.size() * sizeof(SceneMesh::TileOffset) );
+    return true;
+}
+
+bool MosaicScene::isEmpty() const
+{
+    return tilesCount == 0;
+}
+
+float MosaicScene::getWidth() const
+{
+    return mesh.getWidth();
+}
+
+float MosaicScene::getHeight() const
+{
+    return mesh.getHeight();
+}
+
+/**
+ * @brief draw function, camera matrices must already be in the camera uniform block.
+ * Grids of all tiles are one indirect multi-draw, seams are another one drawn over them with the comparison line color
+ */
+void MosaicScene::draw()
+{
+    if ( isEmpty() )
+    {
+        return;
+    }
+    shaderProgram.bind();
+    functions.glBindVertexArray(vao);
+    commandBuffer.bind();
+    functions.glBindBufferBase( GL_SHADER_STORAGE_BUFFER, TILE_OFFSETS_BINDING, tileOffsetsBuffer.getId() );
+
+    shaderProgram.setUniformValue( uniforms[UniformLocationCache::COLOR], QVector4D( 1.0f, 1.0f, 1.0f, 1.0f ) );
+    shaderProgram.setUniformValue( uniforms[UniformLocationCache::APPLY_HEIGHT_COLORING], true );
+    functions.glMultiDrawElementsIndirect( GL_LINE_STRIP, GL_UNSIGNED_INT, nullptr, tilesCount, 0 );
+
+    //seams lie on the grid lines of the edges, so they must pass the depth test against them
+    shaderProgram.setUniformValue( uniforms[UniformLocationCache::APPLY_HEIGHT_COLORING], false );
+    shaderProgram.setUniformValue( uniforms[UniformLocationCache::COLOR], QVector4D( 1.0f, 1.0f, 0.0f, 1.0f ) );
+    functions.glLineWidth(2.0f);
+    functions.glDepthFunc(GL_LEQUAL);
+    functions.glMultiDrawElementsIndirect( GL_LINE_STRIP, GL_UNSIGNED_INT,
+                                           (const void *)( tilesCount * sizeof(SceneMesh::DrawCommand) ), tilesCount, 0 );
+    functions.glDepthFunc(GL_LESS);
+    functions.glLineWidth(1.0f);
+
+    functions.glBindBuffer( GL_DRAW_INDIRECT_BUFFER, 0 );
+    functions.glBindVertexArray(0);
+    shaderProgram.release();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <QOpenGLFunctions_4_3_Core>
+
+#include "SceneMesh.h"
+#include "StreamingBuffer.h"
+#include "UniformLocationCache.h"
+
+class QOpenGLShaderProgram;
+
+/**
+ * @brief Represents a mosaic of many matrices in one view, renders data built by SceneMesh.
+ * All tiles share one vertex, one index and one indirect command buffer, world offsets of tiles are read from a storage buffer,
+ * so the whole mosaic is drawn by one multi-draw call for grids and one for the seams between tiles
+ */
+class MosaicScene
+{
+public:
+    MosaicScene( QOpenGLShaderProgram & shaderProgram,
+                 QOpenGLFunctions_4_3_Core & functions );
+    ~MosaicScene();
+    bool update( const std::vector<HeightMatrix> & TILES,
+                 size_t rows,
+                 size_t columns );
+    bool isEmpty() const;
+    float getWidth() const;
+    float getHeight() const;
+    void draw();
+
+private:
+    SceneMesh mesh;
+    QOpenGLShaderProgram & shaderProgram;
+    QOpenGLFunctions_4_3_Core & functions;
+    UniformLocationCache uniforms;
+    GLuint vao;
+    StreamingBuffer vertexBuffer;
+    StreamingBuffer tileIndexBuffer;
+    StreamingBuffer indexBuffer;
+    //grid commands of all tiles followed by seam commands of all tiles
+    StreamingBuffer commandBuffer;
+    StreamingBuffer tileOffsetsBuffer;
+    GLsizei tilesCount;
+};
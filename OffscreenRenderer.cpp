@@ -0,0 +1,299 @@
+#include "OffscreenRenderer.h"
+
+#include <algorithm>
+
+#include "ShaderProgramCache.h"
+
+namespace
+{
+    //camera of the matrix views, the same as in MatrixWidget
+    const float FOV = 40.0f;
+    const float NEAR_DISTANCE = 0.1f;
+}
+
+/**
+ * @brief creates OpenGL 4.5 context with an offscreen surface and a framebuffer of a given size
+ * @param width width of the rendered images
+ * @param height height of the rendered images
+ */
+OffscreenRenderer::OffscreenRenderer( int width,
+                                      int height )
+    : valid(false)
+    , profilesVao(0)
+    , eyePosition( 20.0f, 20.0f, 20.0f )
+    , farDistance(300.0f)
+{
+    //shaders are GLSL 4.50
+    QSurfaceFormat format;
+    format.setVersion( 4, 5 );
+    format.setProfile( QSurfaceFormat::CoreProfile );
+    surface.setFormat(format);
+    surface.create();
+    context.setFormat(format);
+    if ( !context.create() || !context.makeCurrent( &surface ) )
+    {
+        qWarning( "Unable to create OpenGL context for offscreen rendering" );
+        return;
+    }
+    if ( !functions.initializeOpenGLFunctions() )
+    {
+        qWarning( "OpenGL 4.3 functions are not available for offscreen rendering" );
+        return;
+    }
+
+    QOpenGLFramebufferObjectFormat framebufferFormat;
+    framebufferFormat.setAttachment( QOpenGLFramebufferObject::CombinedDepthStencil );
+    framebuffer = std::make_unique<QOpenGLFramebufferObject>( width, height, framebufferFormat );
+    if ( !framebuffer->isValid() )
+    {
+        qWarning( "Unable to create %dx%d framebuffer for offscreen rendering", width, height );
+        return;
+    }
+    functions.glEnable(GL_PROGRAM_POINT_SIZE);
+
+    gridShaderProgram = ShaderProgramCache::get( ShaderProgramCache::GRID );
+    gridTextureShaderProgram = ShaderProgramCache::get( ShaderProgramCache::GRID_TEXTURE );
+    csShaderProgram = ShaderProgramCache::get( ShaderProgramCache::COORDINATE_SYSTEM );
+    cameraBlock = std::make_unique<CameraBlock>(functions);
+    grid = std::make_unique<Grid>( *gridShaderProgram, *gridTextureShaderProgram, functions );
+    coordinateSystem = std::make_unique<CoordinateSystem>( *csShaderProgram, functions );
+
+    //profile lines use their own (x;y) stream, core profile needs a vertex array object for it
+    functions.glGenVertexArrays( 1, &profilesVao );
+    functions.glBindVertexArray(profilesVao);
+    profilesBuffer = std::make_unique<StreamingBuffer>( functions, GL_ARRAY_BUFFER, GL_STREAM_DRAW );
+    profilesBuffer->bind();
+    functions.glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 0, 0 );
+    functions.glEnableVertexAttribArray(0);
+    functions.glBindVertexArray(0);
+    uniforms.resolve(*gridShaderProgram);
+    valid = true;
+}
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+    //GL objects and shared programs have to be released within the context
+    if ( !context.isValid() || !context.makeCurrent( &surface ) )
+    {
+        return;
+    }
+    profilesBuffer.reset();
+    functions.glDeleteVertexArrays( 1, &profilesVao );
+    coordinateSystem.reset();
+    grid.reset();
+    cameraBlock.reset();
+    gridShaderProgram.reset();
+    gridTextureShaderProgram.reset();
+    csShaderProgram.reset();
+    framebuffer.reset();
+    context.doneCurrent();
+}
+
+/**
+ * @brief whether context, framebuffer and programs have been created
+ */
+bool OffscreenRenderer::isValid() const
+{
+    return valid;
+}
+
+/**
+ * @brief sets camera position of the matrix views, camera always looks at the origin
+ * @param EYE_POSITION camera position
+ */
+void OffscreenRenderer::setEyePosition( const QVector3D & EYE_POSITION )
+{
+    eyePosition = EYE_POSITION;
+    farDistance = std::max( 300.0f, EYE_POSITION.length() * 4.0f );
+}
+
+/**
+ * @brief moves camera along the diagonal of the application default view, so that the whole matrix is in view
+ * @param MATRIX matrix to render
+ */
+void OffscreenRenderer::fitEyePosition( const HeightMatrix & MATRIX )
+{
+    float size = (float)( std::max( MATRIX.getWidth(), MATRIX.getHeight() ) * MATRIX.getPrecision() );
+    float distance = std::max( 20.0f, size * 0.9f );
+    setEyePosition( QVector3D( distance, distance, distance ) );
+}
+
+/**
+ * @brief renders a matrix view as MatrixWidget shows it.
+ * Any matrix may be rendered after any other one; heights of the matrix rendered last are refreshed only inside its
+ * dirty rectangles, so its rectangles must not be cleared between modifying it and rendering it again
+ * @param MATRIX matrix
+ * @param side side of the comparison line
+ * @param heightTexture render matrix mesh from the height texture instead of the vertex mesh
+ * @param showFlatGrid render flat grid layer
+ * @return rendered image, null image if the renderer is not valid
+ */
+QImage OffscreenRenderer::renderMatrix( const HeightMatrix & MATRIX,
+                                        COMPARISON_SIDE side,
+                                        bool heightTexture,
+                                        bool showFlatGrid )
+{
+    if ( !makeCurrent() )
+    {
+        return QImage();
+    }
+    Grid::RENDER_MODE renderMode = heightTexture ? Grid::HEIGHT_TEXTURE : Grid::VERTEX_MESH;
+    if ( grid->getRenderMode() != renderMode )
+    {
+        grid->setRenderMode(renderMode);
+    }
+    grid->setShowFlatGrid(showFlatGrid);
+    grid->update( MATRIX, side );
+
+    framebuffer->bind();
+    functions.glViewport( 0, 0, framebuffer->width(), framebuffer->height() );
+    //same clear colors as the master and target matrix widgets
+    if ( MATRIX.getType() == HeightMatrix::MASTER )
+    {
+        functions.glClearColor( 0.1f, 0.0f, 0.0f, 1.0f );
+    }
+    else
+    {
+        functions.glClearColor( 0.0f, 0.0f, 0.1f, 1.0f );
+    }
+    functions.glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+    functions.glEnable(GL_DEPTH_TEST);
+
+    QMatrix4x4 projectionMatrix;
+    projectionMatrix.perspective( FOV, (float)framebuffer->width() / (float)framebuffer->height(), NEAR_DISTANCE, farDistance );
+    QMatrix4x4 viewMatrix;
+    viewMatrix.lookAt( eyePosition, QVector3D( 0.0f, 0.0f, 0.0f ), QVector3D( 0.0f, 1.0f, 0.0f ) );
+    cameraBlock->update( projectionMatrix, viewMatrix );
+    grid->draw( projectionMatrix, viewMatrix );
+    coordinateSystem->draw();
+
+    functions.glDisable(GL_DEPTH_TEST);
+    framebuffer->release();
+    return framebuffer->toImage();
+}
+
+/**
+ * @brief renders original profiles of both matrices as ComparisonSidesWidget shows them: master red, target blue
+ * @param MASTER_MATRIX master matrix
+ * @param TARGET_MATRIX target matrix
+ * @param masterSide side of the master matrix
+ * @param targetSide side of the target matrix
+ * @return rendered image, null image if the renderer is not valid
+ */
+QImage OffscreenRenderer::renderProfiles( const HeightMatrix & MASTER_MATRIX,
+                                          const HeightMatrix & TARGET_MATRIX,
+                                          COMPARISON_SIDE masterSide,
+                                          COMPARISON_SIDE targetSide )
+{
+    if ( !makeCurrent() )
+    {
+        return QImage();
+    }
+    auto projectionDistance = []( const HeightMatrix & MATRIX, COMPARISON_SIDE side ) {
+        bool isVerticalSide = side == COMPARISON_SIDE::LEFT || side == COMPARISON_SIDE::RIGHT;
+        return (float)( ( isVerticalSide ? MATRIX.getHeight() : MATRIX.getWidth() ) * MATRIX.getPrecision() );
+    };
+    const std::vector<float> & MASTER_PROFILE = MASTER_MATRIX.getEdgeProfile(masterSide);
+    profilesVertices.clear();
+    bufferProfileVertices( MASTER_PROFILE, (float)MASTER_MATRIX.getPrecision() );
+    bufferProfileVertices( TARGET_MATRIX.getEdgeProfile(targetSide), (float)TARGET_MATRIX.getPrecision() );
+    return drawProfiles( MASTER_PROFILE.size(),
+                         QVector4D( 1.0f, 0.0f, 0.0f, 1.0f ),
+                         QVector4D( 0.0f, 0.0f, 1.0f, 1.0f ),
+                         std::max( projectionDistance( MASTER_MATRIX, masterSide ), projectionDistance( TARGET_MATRIX, targetSide ) ) );
+}
+
+/**
+ * @brief couples target matrix with master matrix in place and renders the target profile before and after
+ * as ArrangementWidget shows them: original blue, arranged purple
+ * @param MASTER_MATRIX master matrix
+ * @param targetMatrix target matrix, coupled by the call
+ * @param masterSide side of the master matrix to couple with
+ * @param targetSide side of the target matrix to couple
+ * @return rendered image, null image if the renderer is not valid or matrices could not be coupled
+ */
+QImage OffscreenRenderer::renderArrangement( const HeightMatrix & MASTER_MATRIX,
+                                             HeightMatrix & targetMatrix,
+                                             COMPARISON_SIDE masterSide,
+                                             COMPARISON_SIDE targetSide )
+{
+    if ( !makeCurrent() || !couplingEngine.couple( MASTER_MATRIX, targetMatrix, masterSide, targetSide ) )
+    {
+        return QImage();
+    }
+    const std::vector<float> & ORIGINAL_PROFILE = couplingEngine.getOriginalProfile();
+    profilesVertices.clear();
+    bufferProfileVertices( ORIGINAL_PROFILE, 1.0f );
+    bufferProfileVertices( couplingEngine.getArrangedProfile(), 1.0f );
+    return drawProfiles( ORIGINAL_PROFILE.size(),
+                         QVector4D( 0.0f, 0.0f, 1.0f, 1.0f ),
+                         QVector4D( 1.0f, 0.0f, 1.0f, 1.0f ),
+                         (float)ORIGINAL_PROFILE.size() );
+}
+
+bool OffscreenRenderer::makeCurrent()
+{
+    return valid && context.makeCurrent( &surface );
+}
+
+/**
+ * @brief appends (x;y) vertices of a profile, X coordinate is the index of a height value scaled by precision
+ * @param PROFILE height values of the profile
+ * @param precision distance between adjacent heights
+ */
+void OffscreenRenderer::bufferProfileVertices( const std::vector<float> & PROFILE,
+                                               float precision )
+{
+    profilesVertices.reserve( profilesVertices.size() + PROFILE.size() * 2 );
+    for ( size_t index = 0; index < PROFILE.size(); index++ )
+    {
+        profilesVertices.emplace_back( index * precision );
+        profilesVertices.emplace_back( PROFILE[index] );
+    }
+}
+
+/**
+ * @brief draws two profile lines with points stored one after another in the profiles storage
+ * @param firstProfileVertices number of vertices of the first profile
+ * @param FIRST_COLOR color of the first profile
+ * @param SECOND_COLOR color of the second profile
+ * @param projectionDistance horizontal extent of the view
+ */
+QImage OffscreenRenderer::drawProfiles( size_t firstProfileVertices,
+                                        const QVector4D & FIRST_COLOR,
+                                        const QVector4D & SECOND_COLOR,
+                                        float projectionDistance )
+{
+    const GLsizeiptr VERTEX_SIZE = 2 * sizeof(float);
+    GLintptr offset = profilesBuffer->stream( profilesVertices.data(), profilesVertices.size() * sizeof(float), VERTEX_SIZE );
+    GLint firstVertex = (GLint)( offset / VERTEX_SIZE );
+    GLsizei firstCount = (GLsizei)firstProfileVertices;
+    GLsizei secondCount = (GLsizei)( profilesVertices.size() / 2 - firstProfileVertices );
+
+    framebuffer->bind();
+    functions.glViewport( 0, 0, framebuffer->width(), framebuffer->height() );
+    functions.glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
+    functions.glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+    QMatrix4x4 projectionMatrix;
+    projectionMatrix.ortho( 0.0f, projectionDistance, 0.0f, HeightMatrix::MAX_HEIGHT, 0.1f, 2.0f );
+    QMatrix4x4 viewMatrix;
+    viewMatrix.lookAt( QVector3D( 0.0f, 0.0f, 1.0f ), QVector3D( 0.0f, 0.0f, 0.0f ), QVector3D( 0.0f, 1.0f, 0.0f ) );
+    cameraBlock->update( projectionMatrix, viewMatrix );
+
+    gridShaderProgram->bind();
+    gridShaderProgram->setUniformValue( uniforms[UniformLocationCache::SEPARATE_HEIGHTS], false );
+    gridShaderProgram->setUniformValue( uniforms[UniformLocationCache::APPLY_HEIGHT_COLORING], false );
+    functions.glBindVertexArray(profilesVao);
+    gridShaderProgram->setUniformValue( uniforms[UniformLocationCache::COLOR], FIRST_COLOR );
+    functions.glDrawArrays( GL_LINE_STRIP, firstVertex, firstCount );
+    functions.glDrawArrays( GL_POINTS, firstVertex, firstCount );
+    gridShaderProgram->setUniformValue( uniforms[UniformLocationCache::COLOR], SECOND_COLOR );
+    functions.glDrawArrays( GL_LINE_STRIP, firstVertex + firstCount, secondCount );
+    functions.glDrawArrays( GL_POINTS, firstVertex + firstCount, secondCount );
+    profilesBuffer->fence();
+    functions.glBindVertexArray(0);
+
+    framebuffer->release();
+    return framebuffer->toImage();
+}
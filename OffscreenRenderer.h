@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QImage>
+#include <QMatrix4x4>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions_4_3_Core>
+#include <QOpenGLShaderProgram>
+#include <memory>
+#include <vector>
+
+#include "CameraBlock.h"
+#include "CoordinateSystem.h"
+#include "CouplingEngine.h"
+#include "Grid.h"
+#include "StreamingBuffer.h"
+#include "UniformLocationCache.h"
+
+/**
+ * @brief Renders the views of the application without any window: an offscreen surface and a framebuffer object of a given size
+ * replace the widgets, matrix views reuse Grid and CoordinateSystem and profile views draw the same lines as the profile widgets.
+ * Needs only an OpenGL 4.5 context, so it runs under Mesa software rendering with the offscreen platform plugin
+ * @note a QGuiApplication must exist, the renderer makes its own context current on every call
+ */
+class OffscreenRenderer
+{
+public:
+    OffscreenRenderer( int width,
+                       int height );
+    ~OffscreenRenderer();
+    bool isValid() const;
+    void setEyePosition( const QVector3D & EYE_POSITION );
+    void fitEyePosition( const HeightMatrix & MATRIX );
+    QImage renderMatrix( const HeightMatrix & MATRIX,
+                         COMPARISON_SIDE side,
+                         bool heightTexture = false,
+                         bool showFlatGrid = false );
+    QImage renderProfiles( const HeightMatrix & MASTER_MATRIX,
+                           const HeightMatrix & TARGET_MATRIX,
+                           COMPARISON_SIDE masterSide,
+                           COMPARISON_SIDE targetSide );
+    QImage renderArrangement( const HeightMatrix & MASTER_MATRIX,
+                              HeightMatrix & targetMatrix,
+                              COMPARISON_SIDE masterSide,
+                              COMPARISON_SIDE targetSide );
+
+private:
+    bool makeCurrent();
+    void bufferProfileVertices( const std::vector<float> & PROFILE,
+                                float precision );
+    QImage drawProfiles( size_t firstProfileVertices,
+                         const QVector4D & FIRST_COLOR,
+                         const QVector4D & SECOND_COLOR,
+                         float projectionDistance );
+
+private:
+    QOffscreenSurface surface;
+    QOpenGLContext context;
+    QOpenGLFunctions_4_3_Core functions;
+    bool valid;
+    std::unique_ptr<QOpenGLFramebufferObject> framebuffer;
+    std::shared_ptr<QOpenGLShaderProgram> gridShaderProgram;
+    std::shared_ptr<QOpenGLShaderProgram> gridTextureShaderProgram;
+    std::shared_ptr<QOpenGLShaderProgram> csShaderProgram;
+    std::unique_ptr<CameraBlock> cameraBlock;
+    std::unique_ptr<Grid> grid;
+    std::unique_ptr<CoordinateSystem> coordinateSystem;
+    //(x;y) profile lines, drawn with the grid program like in the profile widgets
+    GLuint profilesVao;
+    std::unique_ptr<StreamingBuffer> profilesBuffer;
+    std::vector<float> profilesVertices;
+    UniformLocationCache uniforms;
+    CouplingEngine couplingEngine;
+    QVector3D eyePosition;
+    float farDistance;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief number of worker threads to use when none is requested explicitly
+ * @return number of hardware threads, at least one
+ * @note queried once, the query itself is a system call on some platforms
+ */
+inline unsigned int defaultThreadCount()
+{
+    static const unsigned int THREAD_COUNT = std::max( 1u, std::thread::hardware_concurrency() );
+    return THREAD_COUNT;
+}
+
+/**
+ * @brief calls function(index) for every index in [0; count) spread over a number of threads, blocks until all calls are done.
+ * Indices are handed out one by one, so jobs of different length are balanced between threads
+ * @param count number of indices
+ * @param function callable taking size_t index
+ * @param threadCount number of threads to use including the calling one, 0 means one per hardware thread
+ */
+template<typename Function>
+void parallelFor( size_t count,
+                  Function function,
+                  unsigned int threadCount = 0 )
+{
+    if ( threadCount == 0 )
+    {
+        threadCount = defaultThreadCount();
+    }
+    threadCount = (unsigned int)std::min<size_t>( threadCount, count );
+    if ( threadCount <= 1 )
+    {
+        for ( size_t index = 0; index < count; index++ )
+        {
+            function(index);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextIndex(0);
+    auto worker = [&nextIndex, &function, count]() {
+        for ( size_t index = nextIndex++; index < count; index = nextIndex++ )
+        {
+            function(index);
+        }
+    };
+
+    //calling thread works as well
+    std::vector<std::thread> threads;
+    threads.reserve( threadCount - 1 );
+    for ( unsigned int threadIndex = 1; threadIndex < threadCount; threadIndex++ )
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for ( std::thread & thread : threads )
+    {
+        thread.join();
+    }
+}
@@ -0,0 +1,462 @@
+#include "PolyphaseResampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "CpuFeatures.h"
+#include "ParallelFor.h"
+
+#ifdef COUPLING_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    //widest vector of target cells, unrolled periods are multiples of it
+    constexpr unsigned int VECTOR_WIDTH = 8;
+    //smallest number of cells resampled by one parallel job, smaller jobs cost more to hand out than to run
+    constexpr size_t MIN_CELLS_PER_JOB = 16 * 1024;
+
+    int64_t floorDivide( int64_t numerator,
+                         int64_t denominator )
+    {
+        int64_t quotient = numerator / denominator;
+        return ( numerator % denominator != 0 && ( numerator < 0 ) != ( denominator < 0 ) ) ? quotient - 1 : quotient;
+    }
+
+    void resampleScalar( const float * SOURCE,
+                         const PolyphaseResampler::FilterBank & BANK,
+                         size_t begin,
+                         size_t end,
+                         float * output )
+    {
+        unsigned int entry = (unsigned int)( begin % BANK.period );
+        const float * periodSource = SOURCE + begin / BANK.period * BANK.sourcePeriod;
+        for ( size_t target = begin; target < end; target++ )
+        {
+            const float * taps = periodSource + BANK.firstTaps[entry];
+            float value = BANK.weights[entry] * taps[0];
+            for ( unsigned int tap = 1; tap < BANK.taps; tap++ )
+            {
+                value += BANK.weights[tap * BANK.period + entry] * taps[tap];
+            }
+            output[target] = value;
+            if ( ++entry == BANK.period )
+            {
+                entry = 0;
+                periodSource += BANK.sourcePeriod;
+            }
+        }
+    }
+
+    void accumulateLineScalar( float * line,
+                               const float * SOURCE,
+                               float weight,
+                               size_t length,
+                               bool first )
+    {
+        if (first)
+        {
+            for ( size_t index = 0; index < length; index++ )
+            {
+                line[index] = SOURCE[index] * weight;
+            }
+        }
+        else
+        {
+            for ( size_t index = 0; index < length; index++ )
+            {
+                line[index] += SOURCE[index] * weight;
+            }
+        }
+    }
+
+#ifdef COUPLING_X86_SIMD
+    /**
+     * @brief 8 target cells per iteration, taps of each cell are gathered from their source cells.
+     * SSE2 has no gather, CPUs without AVX2 use the scalar kernel
+     */
+    COUPLING_TARGET_AVX2
+    void resampleAvx2( const float * SOURCE,
+                       const PolyphaseResampler::FilterBank & BANK,
+                       size_t begin,
+                       size_t end,
+                       float * output )
+    {
+        //vector blocks start at multiples of the vector width, so they never cross an unrolled period
+        size_t blocksBegin = std::min( end, ( begin + VECTOR_WIDTH - 1 ) / VECTOR_WIDTH * VECTOR_WIDTH );
+        size_t blocksEnd = std::max( blocksBegin, end / VECTOR_WIDTH * VECTOR_WIDTH );
+        resampleScalar( SOURCE, BANK, begin, blocksBegin, output );
+
+        unsigned int entry = (unsigned int)( blocksBegin % BANK.period );
+        const float * periodSource = SOURCE + blocksBegin / BANK.period * BANK.sourcePeriod;
+        for ( size_t target = blocksBegin; target < blocksEnd; target += VECTOR_WIDTH )
+        {
+            __m256i firstTaps = _mm256_load_si256( (const __m256i *)( BANK.firstTaps.data() + entry ) );
+            __m256 value = _mm256_mul_ps( _mm256_load_ps( BANK.weights.data() + entry ),
+                                          _mm256_i32gather_ps( periodSource, firstTaps, 4 ) );
+            for ( unsigned int tap = 1; tap < BANK.taps; tap++ )
+            {
+                __m256 weights = _mm256_load_ps( BANK.weights.data() + tap * BANK.period + entry );
+                value = _mm256_add_ps( value, _mm256_mul_ps( weights, _mm256_i32gather_ps( periodSource + tap, firstTaps, 4 ) ) );
+            }
+            _mm256_storeu_ps( output + target, value );
+            entry += VECTOR_WIDTH;
+            if ( entry == BANK.period )
+            {
+                entry = 0;
+                periodSource += BANK.sourcePeriod;
+            }
+        }
+
+        _mm256_zeroupper();
+        resampleScalar( SOURCE, BANK, blocksEnd, end, output );
+    }
+
+    COUPLING_TARGET_SSE2
+    void accumulateLineSse2( float * line,
+                             const float * SOURCE,
+                             float weight,
+                             size_t length,
+                             bool first )
+    {
+        const __m128 WEIGHT = _mm_set1_ps(weight);
+        size_t index = 0;
+        for ( ; index + 4 <= length; index += 4 )
+        {
+            __m128 weighted = _mm_mul_ps( _mm_loadu_ps( SOURCE + index ), WEIGHT );
+            _mm_storeu_ps( line + index, first ? weighted : _mm_add_ps( _mm_loadu_ps( line + index ), weighted ) );
+        }
+        accumulateLineScalar( line + index, SOURCE + index, weight, length - index, first );
+    }
+
+    COUPLING_TARGET_AVX2
+    void accumulateLineAvx2( float * line,
+                             const float * SOURCE,
+                             float weight,
+                             size_t length,
+                             bool first )
+    {
+        const __m256 WEIGHT = _mm256_set1_ps(weight);
+        size_t index = 0;
+        for ( ; index + 8 <= length; index += 8 )
+        {
+            __m256 weighted = _mm256_mul_ps( _mm256_loadu_ps( SOURCE + index ), WEIGHT );
+            _mm256_storeu_ps( line + index, first ? weighted : _mm256_add_ps( _mm256_loadu_ps( line + index ), weighted ) );
+        }
+        //upper halves are cleared before legacy SSE code
+        _mm256_zeroupper();
+        accumulateLineSse2( line + index, SOURCE + index, weight, length - index, first );
+    }
+#endif
+}
+
+/**
+ * @param ratio target cells per source cell, i.e. source precision divided by target precision
+ */
+PolyphaseResampler::PolyphaseResampler( double ratio )
+    : phases(0)
+    , sourceStep(0)
+    , kernel( selectKernel() )
+    , lineKernel( selectLineKernel() )
+{
+    setRatio(ratio);
+}
+
+/**
+ * @brief sets the resampling ratio, the filter bank is only rebuilt when its fraction changes.
+ * The ratio is replaced by the closest continued fraction convergent with both terms up to MAX_PHASES
+ * @param ratio target cells per source cell, i.e. source precision divided by target precision, limited to [1/MAX_PHASES; MAX_PHASES]
+ */
+void PolyphaseResampler::setRatio( double ratio )
+{
+    if ( !( ratio > 0.0 ) )
+    {
+        ratio = 1.0;
+    }
+    ratio = std::min( std::max( ratio, 1.0 / MAX_PHASES ), (double)MAX_PHASES );
+
+    uint64_t bestNumerator = ratio >= 1.0 ? (uint64_t)std::lround(ratio) : 1;
+    uint64_t bestDenominator = ratio >= 1.0 ? 1 : (uint64_t)std::lround( 1.0 / ratio );
+    uint64_t numerators[2] = { 0, 1 };
+    uint64_t denominators[2] = { 1, 0 };
+    double remainder = ratio;
+    for ( int term = 0; term < 64; term++ )
+    {
+        uint64_t wholePart = (uint64_t)std::floor(remainder);
+        uint64_t numerator = wholePart * numerators[1] + numerators[0];
+        uint64_t denominator = wholePart * denominators[1] + denominators[0];
+        if ( numerator > MAX_PHASES || denominator > MAX_PHASES )
+        {
+            break;
+        }
+        if ( numerator > 0 &&
+             std::abs( (double)numerator / denominator - ratio ) <= std::abs( (double)bestNumerator / bestDenominator - ratio ) )
+        {
+            bestNumerator = numerator;
+            bestDenominator = denominator;
+        }
+        numerators[0] = numerators[1];
+        numerators[1] = numerator;
+        denominators[0] = denominators[1];
+        denominators[1] = denominator;
+        double fraction = remainder - std::floor(remainder);
+        if ( fraction < 1e-9 || std::abs( (double)numerator / denominator - ratio ) <= 1e-12 * ratio )
+        {
+            break;
+        }
+        remainder = 1.0 / fraction;
+    }
+
+    if ( bestNumerator == phases && bestDenominator == sourceStep )
+    {
+        return;
+    }
+    phases = (unsigned int)bestNumerator;
+    sourceStep = (unsigned int)bestDenominator;
+    updateFilterBank();
+}
+
+/**
+ * @brief effective ratio of target cells per source cell after the approximation by a fraction
+ */
+double PolyphaseResampler::getRatio() const
+{
+    return (double)phases / sourceStep;
+}
+
+/**
+ * @brief target cells per period of the ratio fraction, i.e. number of distinct filter phases
+ */
+unsigned int PolyphaseResampler::getPhases() const
+{
+    return phases;
+}
+
+/**
+ * @brief source cells per period of the ratio fraction
+ */
+unsigned int PolyphaseResampler::getSourceStep() const
+{
+    return sourceStep;
+}
+
+/**
+ * @brief source cells every target cell is computed from
+ */
+unsigned int PolyphaseResampler::getTaps() const
+{
+    return bank.taps;
+}
+
+/**
+ * @brief calculates number of target cells covering the extent of a source line
+ * @param sourceLength number of source cells
+ * @return number of target cells whose positions lie within the source line, including the first one
+ */
+size_t PolyphaseResampler::getResampledLength( size_t sourceLength ) const
+{
+    return sourceLength == 0 ? 0 : ( sourceLength - 1 ) * phases / sourceStep + 1;
+}
+
+/**
+ * @brief resamples a source line into a preallocated output.
+ * Taps beyond the line ends repeat the end cells
+ * @param SOURCE contiguous source heights
+ * @param sourceLength number of source heights
+ * @param output storage for resampled values
+ * @param outputLength capacity of the output, resampling stops when it is exhausted
+ * @return number of values written
+ */
+size_t PolyphaseResampler::resample( const float * SOURCE,
+                                     size_t sourceLength,
+                                     float * output,
+                                     size_t outputLength ) const
+{
+    size_t resampledLength = std::min( getResampledLength(sourceLength), outputLength );
+    if ( resampledLength == 0 )
+    {
+        return 0;
+    }
+
+    //first taps only grow along the line, so the cells whose taps all lie inside the source form one range
+    size_t interiorBegin = 0;
+    while ( interiorBegin < resampledLength && firstTap(interiorBegin) < 0 )
+    {
+        interiorBegin++;
+    }
+    size_t interiorEnd = resampledLength;
+    while ( interiorEnd > interiorBegin && firstTap( interiorEnd - 1 ) + bank.taps > (int64_t)sourceLength )
+    {
+        interiorEnd--;
+    }
+
+    resampleClamped( SOURCE, sourceLength, 0, interiorBegin, output );
+    kernel( SOURCE, bank, interiorBegin, interiorEnd, output );
+    resampleClamped( SOURCE, sourceLength, interiorEnd, resampledLength, output );
+    return resampledLength;
+}
+
+/**
+ * @brief converts a matrix to another precision, the result covers the extent of the source.
+ * Rows are resampled first, then every target row is a weighted sum of whole resampled rows, both passes run in parallel
+ * @param SOURCE source matrix
+ * @param precision precision of the result
+ * @param threadCount number of threads, 0 means one per hardware thread
+ * @return matrix of the given precision and the type of the source, empty if the source is empty or the precision is not positive
+ * @note sets the ratio of the resampler
+ */
+HeightMatrix PolyphaseResampler::resampleMatrix( const HeightMatrix & SOURCE,
+                                                 double precision,
+                                                 unsigned int threadCount )
+{
+    if ( SOURCE.getWidth() == 0 || SOURCE.getHeight() == 0 || !( precision > 0.0 ) )
+    {
+        return HeightMatrix( 0, 0, precision, SOURCE.getType() );
+    }
+    setRatio( SOURCE.getPrecision() / precision );
+
+    const size_t SOURCE_WIDTH = SOURCE.getWidth();
+    const size_t SOURCE_HEIGHT = SOURCE.getHeight();
+    const size_t WIDTH = getResampledLength(SOURCE_WIDTH);
+    const size_t HEIGHT = getResampledLength(SOURCE_HEIGHT);
+    const size_t ROWS_PER_JOB = std::max( (size_t)1, MIN_CELLS_PER_JOB / WIDTH );
+
+    //rows pass, source rows turn into rows of the target width
+    HeightMatrix rows( WIDTH, SOURCE_HEIGHT, precision, SOURCE.getType() );
+    const float * SOURCE_VALUES = SOURCE.data();
+    const size_t SOURCE_STRIDE = SOURCE.getStride();
+    float * rowValues = rows.data();
+    const size_t STRIDE = rows.getStride();
+    parallelFor( ( SOURCE_HEIGHT + ROWS_PER_JOB - 1 ) / ROWS_PER_JOB, [&]( size_t job ) {
+        size_t lastRow = std::min( SOURCE_HEIGHT, ( job + 1 ) * ROWS_PER_JOB );
+        for ( size_t row = job * ROWS_PER_JOB; row < lastRow; row++ )
+        {
+            resample( SOURCE_VALUES + row * SOURCE_STRIDE, SOURCE_WIDTH, rowValues + row * STRIDE, WIDTH );
+        }
+    }, threadCount );
+
+    //columns pass over contiguous rows, taps beyond the matrix repeat its first or last row
+    HeightMatrix result( WIDTH, HEIGHT, precision, SOURCE.getType() );
+    float * values = result.data();
+    parallelFor( ( HEIGHT + ROWS_PER_JOB - 1 ) / ROWS_PER_JOB, [&]( size_t job ) {
+        size_t lastRow = std::min( HEIGHT, ( job + 1 ) * ROWS_PER_JOB );
+        for ( size_t row = job * ROWS_PER_JOB; row < lastRow; row++ )
+        {
+            int64_t first = firstTap(row);
+            for ( unsigned int tap = 0; tap < bank.taps; tap++ )
+            {
+                int64_t sourceRow = std::min( std::max( first + tap, (int64_t)0 ), (int64_t)SOURCE_HEIGHT - 1 );
+                lineKernel( values + row * STRIDE, rowValues + sourceRow * STRIDE, weight( row, tap ), WIDTH, tap == 0 );
+            }
+        }
+    }, threadCount );
+    result.commitWrites();
+    return result;
+}
+
+/**
+ * @brief picks the widest line kernel supported by the CPU
+ */
+PolyphaseResampler::Kernel PolyphaseResampler::selectKernel()
+{
+#ifdef COUPLING_X86_SIMD
+    if ( CpuFeatures::hasAvx2() )
+    {
+        return resampleAvx2;
+    }
+#endif
+    return resampleScalar;
+}
+
+/**
+ * @brief picks the widest rows accumulation kernel supported by the CPU
+ */
+PolyphaseResampler::LineKernel PolyphaseResampler::selectLineKernel()
+{
+#ifdef COUPLING_X86_SIMD
+    if ( CpuFeatures::hasAvx2() )
+    {
+        return accumulateLineAvx2;
+    }
+    if ( CpuFeatures::hasSse2() )
+    {
+        return accumulateLineSse2;
+    }
+#endif
+    return accumulateLineScalar;
+}
+
+/**
+ * @brief builds first taps and tent filter weights of every target cell of an unrolled period.
+ * Target cell j lies at source position j * Q / P, the tent is one cell wide on either side when resampling to a finer grid
+ * and Q / P cells wide when resampling to a coarser one, weights of a cell are normalized to sum up to one
+ */
+void PolyphaseResampler::updateFilterBank()
+{
+    const unsigned int UNROLL = VECTOR_WIDTH / std::gcd( phases, VECTOR_WIDTH );
+    //tent half width in source cells multiplied by P, so tap positions stay integer
+    const int64_t HALF_WIDTH = std::max( phases, sourceStep );
+    bank.period = phases * UNROLL;
+    bank.sourcePeriod = sourceStep * UNROLL;
+    bank.taps = (unsigned int)( ( 2 * HALF_WIDTH + phases - 1 ) / phases );
+    bank.firstTaps.assign( bank.period, 0 );
+    bank.weights.assign( (size_t)bank.taps * bank.period, 0.0f );
+
+    std::vector<double> tapWeights(bank.taps);
+    for ( unsigned int entry = 0; entry < bank.period; entry++ )
+    {
+        const int64_t POSITION = (int64_t)entry * sourceStep;
+        const int64_t FIRST = floorDivide( POSITION - HALF_WIDTH, phases ) + 1;
+        bank.firstTaps[entry] = (int32_t)FIRST;
+        double sum = 0.0;
+        for ( unsigned int tap = 0; tap < bank.taps; tap++ )
+        {
+            double distance = std::abs( (double)( ( FIRST + tap ) * phases - POSITION ) ) / HALF_WIDTH;
+            tapWeights[tap] = std::max( 0.0, 1.0 - distance );
+            sum += tapWeights[tap];
+        }
+        for ( unsigned int tap = 0; tap < bank.taps; tap++ )
+        {
+            bank.weights[tap * bank.period + entry] = (float)( tapWeights[tap] / sum );
+        }
+    }
+}
+
+/**
+ * @brief first source cell of a target cell, may lie before the line start or make the last taps run past the line end
+ * @param target index of the target cell
+ */
+int64_t PolyphaseResampler::firstTap( size_t target ) const
+{
+    return (int64_t)( target / bank.period * bank.sourcePeriod ) + bank.firstTaps[target % bank.period];
+}
+
+float PolyphaseResampler::weight( size_t target,
+                                  unsigned int tap ) const
+{
+    return bank.weights[tap * bank.period + target % bank.period];
+}
+
+/**
+ * @brief resamples target cells in [begin; end) with taps clamped to the source line
+ */
+void PolyphaseResampler::resampleClamped( const float * SOURCE,
+                                          size_t sourceLength,
+                                          size_t begin,
+                                          size_t end,
+                                          float * output ) const
+{
+    for ( size_t target = begin; target < end; target++ )
+    {
+        int64_t first = firstTap(target);
+        float value = 0.0f;
+        for ( unsigned int tap = 0; tap < bank.taps; tap++ )
+        {
+            int64_t sourceIndex = std::min( std::max( first + tap, (int64_t)0 ), (int64_t)sourceLength - 1 );
+            value = tap == 0 ? weight( target, tap ) * SOURCE[sourceIndex] : value + weight( target, tap ) * SOURCE[sourceIndex];
+        }
+        output[target] = value;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "AlignedAllocator.h"
+#include "HeightMatrix.h"
+
+/**
+ * @brief Resamples height lines and whole matrices by an arbitrary ratio of precisions.
+ * The ratio is reduced to a fraction P/Q: every Q source cells turn into P target cells, so the P target cells of a period
+ * see the same P filter phases. Each phase has a precomputed set of tap weights of a tent filter as wide as the coarser
+ * of the two grids, which is linear interpolation when resampling to a finer grid and a weighted average of the covered cells when resampling to a coarser one.
+ * Lines are resampled by a gather kernel picked once per CPU; matrices are resampled along rows first,
+ * then along columns by weighted sums of whole contiguous rows
+ */
+class PolyphaseResampler
+{
+public:
+    //largest numerator and denominator of the ratio fraction, ratios that need more are approximated
+    constexpr static unsigned int MAX_PHASES = 1024;
+
+    /**
+     * @brief Filter bank of the current ratio.
+     * Tables are unrolled over several periods so that their length is a multiple of the widest vector,
+     * entry j belongs to target cell j of an unrolled period
+     */
+    struct FilterBank
+    {
+        unsigned int taps;
+        //target cells of an unrolled period and source cells it advances by
+        unsigned int period;
+        unsigned int sourcePeriod;
+        //first source cell of every entry relative to the start of its unrolled period, may be negative near the line start
+        std::vector< int32_t, AlignedAllocator<int32_t, 32> > firstTaps;
+        //weights tap by tap: weights[tap * period + j]
+        std::vector< float, AlignedAllocator<float, 32> > weights;
+    };
+
+    /**
+     * @brief Kernel resampling target cells in [begin; end) whose taps all lie inside the source line
+     */
+    using Kernel = void (*)( const float * SOURCE,
+                             const FilterBank & BANK,
+                             size_t begin,
+                             size_t end,
+                             float * output );
+
+    /**
+     * @brief Kernel adding a weighted source line to an output line, or overwriting the output when first is set
+     */
+    using LineKernel = void (*)( float * line,
+                                 const float * SOURCE,
+                                 float weight,
+                                 size_t length,
+                                 bool first );
+
+    explicit PolyphaseResampler( double ratio = 1.0 );
+    void setRatio( double ratio );
+    double getRatio() const;
+    unsigned int getPhases() const;
+    unsigned int getSourceStep() const;
+    unsigned int getTaps() const;
+    size_t getResampledLength( size_t sourceLength ) const;
+    size_t resample( const float * SOURCE,
+                     size_t sourceLength,
+                     float * output,
+                     size_t outputLength ) const;
+    HeightMatrix resampleMatrix( const HeightMatrix & SOURCE,
+                                 double precision,
+                                 unsigned int threadCount = 0 );
+
+private:
+    static Kernel selectKernel();
+    static LineKernel selectLineKernel();
+    void updateFilterBank();
+    int64_t firstTap( size_t target ) const;
+    float weight( size_t target,
+                  unsigned int tap ) const;
+    void resampleClamped( const float * SOURCE,
+                          size_t sourceLength,
+                          size_t begin,
+                          size_t end,
+                          float * output ) const;
+
+private:
+    //target cells per period (P) and source cells per period (Q)
+    unsigned int phases;
+    unsigned int sourceStep;
+    FilterBank bank;
+    Kernel kernel;
+    LineKernel lineKernel;
+};
@@ -0,0 +1,261 @@
+#include "SceneMesh.h"
+
+#include <limits>
+
+#include "ParallelFor.h"
+
+SceneMesh::SceneMesh()
+    : width(0.0f)
+    , height(0.0f)
+{}
+
+/**
+ * @brief rebuilds the whole scene from the tiles
+ * @param TILES tiles in row-major order
+ * @param rows number of tile rows
+ * @param columns number of tile columns
+ * @return false if tile count does not match, a tile is empty or the scene has too many vertices for 32-bit base vertices,
+ * scene is left empty then
+ */
+bool SceneMesh::build( const std::vector<HeightMatrix> & TILES,
+                       size_t rows,
+                       size_t columns )
+{
+    clear();
+    if ( rows == 0 || columns == 0 || TILES.size() != rows * columns )
+    {
+        return false;
+    }
+    size_t verticesCount = 0;
+    for ( const HeightMatrix & TILE : TILES )
+    {
+        if ( TILE.getWidth() == 0 || TILE.getHeight() == 0 )
+        {
+            return false;
+        }
+        verticesCount += TILE.getWidth() * TILE.getHeight();
+    }
+    if ( verticesCount > (size_t)std::numeric_limits<int32_t>::max() )
+    {
+        return false;
+    }
+
+    gridCommands.reserve( TILES.size() );
+    seamCommands.reserve( TILES.size() );
+    int32_t baseVertex = 0;
+    for ( size_t tileIndex = 0; tileIndex < TILES.size(); tileIndex++ )
+    {
+        const HeightMatrix & TILE = TILES[tileIndex];
+        const TileIndices & INDICES = findOrBuildIndices( TILE.getWidth(), TILE.getHeight() );
+        gridCommands.push_back( DrawCommand{ INDICES.gridCount, 1, INDICES.gridFirst, baseVertex, (uint32_t)tileIndex } );
+        seamCommands.push_back( DrawCommand{ INDICES.seamCount, 1, INDICES.seamFirst, baseVertex, (uint32_t)tileIndex } );
+        baseVertex += (int32_t)( TILE.getWidth() * TILE.getHeight() );
+    }
+    updateTileOffsets( TILES, rows, columns );
+    updateVertices(TILES);
+    return true;
+}
+
+void SceneMesh::clear()
+{
+    vertices.clear();
+    indices.clear();
+    tileIndices.clear();
+    gridCommands.clear();
+    seamCommands.clear();
+    tileOffsets.clear();
+    width = 0.0f;
+    height = 0.0f;
+}
+
+/**
+ * @brief returns local index ranges of a tile size, building them on the first request:
+ * row and column line strips separated by the restart index, and one closed line strip around the edges
+ * @param tileWidth width of the tile
+ * @param tileHeight height of the tile
+ */
+const SceneMesh::TileIndices & SceneMesh::findOrBuildIndices( size_t tileWidth,
+                                                              size_t tileHeight )
+{
+    for ( const TileIndices & EXISTING : tileIndices )
+    {
+        if ( EXISTING.width == tileWidth && EXISTING.height == tileHeight )
+        {
+            return EXISTING;
+        }
+    }
+
+    TileIndices built;
+    built.width = tileWidth;
+    built.height = tileHeight;
+    built.gridFirst = (uint32_t)indices.size();
+    for ( size_t rowIndex = 0; rowIndex < tileHeight; rowIndex++ )
+    {
+        for ( size_t columnIndex = 0; columnIndex < tileWidth; columnIndex++ )
+        {
+            indices.emplace_back( (uint32_t)( rowIndex * tileWidth + columnIndex ) );
+        }
+        indices.emplace_back(PRIMITIVE_RESTART_INDEX);
+    }
+    for ( size_t columnIndex = 0; columnIndex < tileWidth; columnIndex++ )
+    {
+        for ( size_t rowIndex = 0; rowIndex < tileHeight; rowIndex++ )
+        {
+            indices.emplace_back( (uint32_t)( rowIndex * tileWidth + columnIndex ) );
+        }
+        indices.emplace_back(PRIMITIVE_RESTART_INDEX);
+    }
+    built.gridCount = (uint32_t)indices.size() - built.gridFirst;
+
+    //top row, right column, bottom row and left column back to the first cell
+    built.seamFirst = (uint32_t)indices.size();
+    const size_t LAST_ROW = tileHeight - 1;
+    const size_t LAST_COLUMN = tileWidth - 1;
+    for ( size_t columnIndex = 0; columnIndex < tileWidth; columnIndex++ )
+    {
+        indices.emplace_back( (uint32_t)columnIndex );
+    }
+    for ( size_t rowIndex = 1; rowIndex < tileHeight; rowIndex++ )
+    {
+        indices.emplace_back( (uint32_t)( rowIndex * tileWidth + LAST_COLUMN ) );
+    }
+    for ( size_t columnIndex = LAST_COLUMN; columnIndex-- > 0; )
+    {
+        indices.emplace_back( (uint32_t)( LAST_ROW * tileWidth + columnIndex ) );
+    }
+    for ( size_t rowIndex = LAST_ROW; rowIndex-- > 0; )
+    {
+        indices.emplace_back( (uint32_t)( rowIndex * tileWidth ) );
+    }
+    built.seamCount = (uint32_t)indices.size() - built.seamFirst;
+
+    tileIndices.push_back(built);
+    return tileIndices.back();
+}
+
+/**
+ * @brief places every tile right after its left and upper neighbours, so that shared edges coincide, and centers the scene
+ * @param TILES tiles in row-major order
+ * @param rows number of tile rows
+ * @param columns number of tile columns
+ */
+void SceneMesh::updateTileOffsets( const std::vector<HeightMatrix> & TILES,
+                                   size_t rows,
+                                   size_t columns )
+{
+    auto spanX = [&TILES]( size_t tileIndex ) {
+        return (float)( ( TILES[tileIndex].getWidth() - 1 ) * TILES[tileIndex].getPrecision() );
+    };
+    auto spanZ = [&TILES]( size_t tileIndex ) {
+        return (float)( ( TILES[tileIndex].getHeight() - 1 ) * TILES[tileIndex].getPrecision() );
+    };
+
+    tileOffsets.assign( TILES.size(), TileOffset{ 0.0f, 0.0f, 0.0f, 0.0f } );
+    for ( size_t row = 0; row < rows; row++ )
+    {
+        for ( size_t column = 0; column < columns; column++ )
+        {
+            size_t tileIndex = row * columns + column;
+            if ( column > 0 )
+            {
+                tileOffsets[tileIndex].x = tileOffsets[tileIndex - 1].x + spanX( tileIndex - 1 );
+            }
+            if ( row > 0 )
+            {
+                tileOffsets[tileIndex].z = tileOffsets[tileIndex - columns].z + spanZ( tileIndex - columns );
+            }
+        }
+    }
+
+    //extent is measured along the first row and the first column
+    width = tileOffsets[columns - 1].x + spanX( columns - 1 );
+    height = tileOffsets[( rows - 1 ) * columns].z + spanZ( ( rows - 1 ) * columns );
+    for ( TileOffset & offset : tileOffsets )
+    {
+        offset.x -= width / 2.0f;
+        offset.z -= height / 2.0f;
+    }
+}
+
+/**
+ * @brief writes (x;y;z) vertices of all tiles in tile space, tiles are converted in parallel
+ * @param TILES tiles in row-major order
+ */
+void SceneMesh::updateVertices( const std::vector<HeightMatrix> & TILES )
+{
+    std::vector<size_t> firstFloats( TILES.size() );
+    size_t floatsCount = 0;
+    for ( size_t tileIndex = 0; tileIndex < TILES.size(); tileIndex++ )
+    {
+        firstFloats[tileIndex] = floatsCount;
+        floatsCount += TILES[tileIndex].getWidth() * TILES[tileIndex].getHeight() * 3;
+    }
+    vertices.resize(floatsCount);
+
+    parallelFor( TILES.size(), [&]( size_t tileIndex ) {
+        const HeightMatrix & TILE = TILES[tileIndex];
+        const float PRECISION = (float)TILE.getPrecision();
+        float * vertex = vertices.data() + firstFloats[tileIndex];
+        for ( size_t rowIndex = 0; rowIndex < TILE.getHeight(); rowIndex++ )
+        {
+            HeightMatrix::ConstLineView row = TILE.row(rowIndex);
+            float z = rowIndex * PRECISION;
+            for ( size_t columnIndex = 0; columnIndex < TILE.getWidth(); columnIndex++ )
+            {
+                *vertex++ = columnIndex * PRECISION;
+                *vertex++ = row[columnIndex];
+                *vertex++ = z;
+            }
+        }
+    } );
+}
+
+
+//-------getters-------------
+
+/**
+ * @brief (x;y;z) vertices of all tiles in tile space
+ */
+const std::vector<float> & SceneMesh::getVertices() const
+{
+    return vertices;
+}
+
+/**
+ * @brief local indices of grid and seam strips, shared by tiles of equal dimensions
+ */
+const std::vector<uint32_t> & SceneMesh::getIndices() const
+{
+    return indices;
+}
+
+/**
+ * @brief one grid draw command per tile in row-major order
+ */
+const std::vector<SceneMesh::DrawCommand> & SceneMesh::getGridCommands() const
+{
+    return gridCommands;
+}
+
+/**
+ * @brief one edges outline draw command per tile in row-major order
+ */
+const std::vector<SceneMesh::DrawCommand> & SceneMesh::getSeamCommands() const
+{
+    return seamCommands;
+}
+
+const std::vector<SceneMesh::TileOffset> & SceneMesh::getTileOffsets() const
+{
+    return tileOffsets;
+}
+
+float SceneMesh::getWidth() const
+{
+    return width;
+}
+
+float SceneMesh::getHeight() const
+{
+    return height;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "HeightMatrix.h"
+
+/**
+ * @brief GUI-free packed mesh of a rows x columns mosaic of tiles, drawn with two indirect multi-draw calls.
+ * Vertices of every tile are (x;y;z) triples in tile space, one per cell, stored one tile after another;
+ * tiles of equal dimensions and precision share one range of local indices, which is rebased per tile by its base vertex.
+ * Every tile has a grid draw command and a seam draw command outlining its edges, the base instance of both is the tile index,
+ * which selects the world offset of the tile. Adjacent tiles are placed so that their shared edges coincide
+ */
+class SceneMesh
+{
+public:
+    //largest 32-bit index, compared before the base vertex is added, so local indices never collide with it
+    constexpr static uint32_t PRIMITIVE_RESTART_INDEX = 0xFFFFFFFF;
+
+    /**
+     * @brief Layout of a DrawElementsIndirectCommand
+     */
+    struct DrawCommand
+    {
+        uint32_t count;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;
+    };
+
+    /**
+     * @brief World offset of a tile, padded to a std430 vec4
+     */
+    struct TileOffset
+    {
+        float x, y, z, w;
+    };
+
+    SceneMesh();
+    bool build( const std::vector<HeightMatrix> & TILES,
+                size_t rows,
+                size_t columns );
+    void clear();
+    const std::vector<float> & getVertices() const;
+    const std::vector<uint32_t> & getIndices() const;
+    const std::vector<DrawCommand> & getGridCommands() const;
+    const std::vector<DrawCommand> & getSeamCommands() const;
+    const std::vector<TileOffset> & getTileOffsets() const;
+    float getWidth() const;
+    float getHeight() const;
+
+private:
+    /**
+     * @brief Index ranges shared by tiles of equal dimensions
+     */
+    struct TileIndices
+    {
+        size_t width, height;
+        uint32_t gridFirst, gridCount;
+        uint32_t seamFirst, seamCount;
+    };
+
+    const TileIndices & findOrBuildIndices( size_t tileWidth,
+                                            size_t tileHeight );
+    void updateTileOffsets( const std::vector<HeightMatrix> & TILES,
+                            size_t rows,
+                            size_t columns );
+    void updateVertices( const std::vector<HeightMatrix> & TILES );
+
+private:
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<TileIndices> tileIndices;
+    std::vector<DrawCommand> gridCommands;
+    std::vector<DrawCommand> seamCommands;
+    std::vector<TileOffset> tileOffsets;
+    float width;
+    float height;
+};
@@ -0,0 +1,66 @@
+#include "ShaderProgramCache.h"
+
+#include <QOpenGLContext>
+#include <map>
+#include <utility>
+
+namespace
+{
+    struct ProgramSources
+    {
+        const char * vertexShader;
+        const char * geometryShader;
+        const char * fragmentShader;
+        const char * name;
+    };
+
+    //sources in the order of PROGRAM values, geometry shader is optional
+    const ProgramSources PROGRAM_SOURCES[ShaderProgramCache::PROGRAMS_COUNT] = {
+        { ":/Shaders/grid/vGrid.glsl", nullptr, ":/Shaders/grid/fGrid.glsl", "grid" },
+        { ":/Shaders/grid/vGridTexture.glsl", nullptr, ":/Shaders/grid/fGrid.glsl", "grid texture" },
+        { ":/Shaders/coordinateSystem/vCS.glsl", ":/Shaders/coordinateSystem/gCS.glsl", ":/Shaders/coordinateSystem/fCS.glsl", "coordinate system" },
+        { ":/Shaders/grid/vScene.glsl", nullptr, ":/Shaders/grid/fGrid.glsl", "scene" }
+    };
+
+    //programs are owned by the widgets using them, so only weak references are kept here
+    std::map<std::pair<QOpenGLContextGroup *, int>, std::weak_ptr<QOpenGLShaderProgram>> sharedPrograms;
+}
+
+/**
+ * @brief returns the program of the current context share group, building it on the first request
+ * @param program program to get
+ * @return linked program, on link failure a warning is printed and the program is returned unlinked
+ */
+std::shared_ptr<QOpenGLShaderProgram> ShaderProgramCache::get( PROGRAM program )
+{
+    QOpenGLContext * context = QOpenGLContext::currentContext();
+    std::pair<QOpenGLContextGroup *, int> key( context ? context->shareGroup() : nullptr, program );
+    std::shared_ptr<QOpenGLShaderProgram> shaderProgram = sharedPrograms[key].lock();
+    if ( !shaderProgram )
+    {
+        shaderProgram = build(program);
+        sharedPrograms[key] = shaderProgram;
+    }
+    return shaderProgram;
+}
+
+/**
+ * @brief compiles and links a program, or loads its binary from Qt program cache if the driver has seen the same sources
+ * @param program program to build
+ */
+std::shared_ptr<QOpenGLShaderProgram> ShaderProgramCache::build( PROGRAM program )
+{
+    const ProgramSources & SOURCES = PROGRAM_SOURCES[program];
+    auto shaderProgram = std::make_shared<QOpenGLShaderProgram>();
+    shaderProgram->addCacheableShaderFromSourceFile( QOpenGLShader::Vertex, SOURCES.vertexShader );
+    if ( SOURCES.geometryShader )
+    {
+        shaderProgram->addCacheableShaderFromSourceFile( QOpenGLShader::Geometry, SOURCES.geometryShader );
+    }
+    shaderProgram->addCacheableShaderFromSourceFile( QOpenGLShader::Fragment, SOURCES.fragmentShader );
+    if ( !shaderProgram->link() )
+    {
+        qWarning( "Unable to link %s shader program", SOURCES.name );
+    }
+    return shaderProgram;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QOpenGLShaderProgram>
+#include <memory>
+
+/**
+ * @brief Shader programs shared by all widgets of one OpenGL share group, every program is compiled and linked once.
+ * Linked binaries are additionally cached on disk by Qt, keyed by the driver and the shader sources,
+ * so later runs skip compilation altogether.
+ * Widgets keep the returned pointers and release them with their context current, the last release deletes the program
+ */
+class ShaderProgramCache
+{
+public:
+    enum PROGRAM
+    {
+        GRID,               //matrix mesh, flat grid and profile lines
+        GRID_TEXTURE,       //matrix mesh generated from the height texture
+        COORDINATE_SYSTEM,  //axes generated by the geometry shader
+        SCENE,              //tiles of a mosaic at their world offsets
+        PROGRAMS_COUNT
+    };
+
+    static std::shared_ptr<QOpenGLShaderProgram> get( PROGRAM program );
+
+private:
+    static std::shared_ptr<QOpenGLShaderProgram> build( PROGRAM program );
+};
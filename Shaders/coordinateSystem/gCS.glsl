@@ -8,8 +8,12 @@ out vec4 v_fColor;
 in vec4 v_gColor[];
 in vec3 v_gDirection[];
 
-uniform mat4 u_projection;
-uniform mat4 u_view;
+//shared by all programs of a context, updated once per frame
+layout (std140, binding = 0) uniform CameraBlock
+{
+    mat4 u_projection;
+    mat4 u_view;
+};
 
 void main()
 {
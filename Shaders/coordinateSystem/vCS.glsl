@@ -2,8 +2,12 @@
 
 layout (location = 1) in vec3 i_color;
 
-uniform mat4 u_projection;
-uniform mat4 u_view;
+//shared by all programs of a context, updated once per frame
+layout (std140, binding = 0) uniform CameraBlock
+{
+    mat4 u_projection;
+    mat4 u_view;
+};
 
 out vec4 v_gColor;
 out vec3 v_gDirection;
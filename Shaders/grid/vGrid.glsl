@@ -1,16 +1,24 @@
 #version 450
 
 layout (location = 0) in vec3 i_pos;
+layout (location = 1) in float i_height;
 out float v_heightAbs;
 
 const float MAX_HEIGHT = 2.0;
 
-uniform mat4 u_projection;
-uniform mat4 u_view;
+//shared by all programs of a context, updated once per frame
+layout (std140, binding = 0) uniform CameraBlock
+{
+    mat4 u_projection;
+    mat4 u_view;
+};
+//position is given as (x;z) in i_pos with the height in a separate stream
+uniform bool u_separateHeights;
 
 void main()
 {
+    vec3 position = u_separateHeights ? vec3(i_pos.x, i_height, i_pos.y) : i_pos;
     gl_PointSize = 4.0;
-    gl_Position = u_projection * u_view * vec4(i_pos, 1.0);
-    v_heightAbs = (i_pos.y / MAX_HEIGHT) * 0.8 + 0.2;
+    gl_Position = u_projection * u_view * vec4(position, 1.0);
+    v_heightAbs = (position.y / MAX_HEIGHT) * 0.8 + 0.2;
 }
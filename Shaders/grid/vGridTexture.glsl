@@ -0,0 +1,29 @@
+#version 450
+
+out float v_heightAbs;
+
+const float MAX_HEIGHT = 2.0;
+
+//shared by all programs of a context, updated once per frame
+layout (std140, binding = 0) uniform CameraBlock
+{
+    mat4 u_projection;
+    mat4 u_view;
+};
+//R32F texture with one texel per matrix cell
+uniform sampler2D u_heights;
+//world position of the first cell and distance between adjacent cells
+uniform vec2 u_origin;
+uniform float u_precision;
+//row strips have one instance per row and one vertex per column, column strips the other way round
+uniform bool u_columnStrips;
+
+void main()
+{
+    ivec2 cell = u_columnStrips ? ivec2(gl_InstanceID, gl_VertexID) : ivec2(gl_VertexID, gl_InstanceID);
+    float height = texelFetch(u_heights, cell, 0).r;
+    vec3 position = vec3(cell.x * u_precision + u_origin.x, height, cell.y * u_precision + u_origin.y);
+    gl_PointSize = 4.0;
+    gl_Position = u_projection * u_view * vec4(position, 1.0);
+    v_heightAbs = (height / MAX_HEIGHT) * 0.8 + 0.2;
+}
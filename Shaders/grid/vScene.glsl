@@ -0,0 +1,28 @@
+#version 450
+
+layout (location = 0) in vec3 i_pos;
+//per instance attribute, the base instance of every draw command is the tile index
+layout (location = 2) in uint i_tile;
+out float v_heightAbs;
+
+const float MAX_HEIGHT = 2.0;
+
+//shared by all programs of a context, updated once per frame
+layout (std140, binding = 0) uniform CameraBlock
+{
+    mat4 u_projection;
+    mat4 u_view;
+};
+//world offset of every tile, position is given in tile space
+layout (std430, binding = 0) readonly buffer TileOffsets
+{
+    vec4 u_tileOffsets[];
+};
+
+void main()
+{
+    vec3 position = i_pos + u_tileOffsets[i_tile].xyz;
+    gl_PointSize = 4.0;
+    gl_Position = u_projection * u_view * vec4(position, 1.0);
+    v_heightAbs = (i_pos.y / MAX_HEIGHT) * 0.8 + 0.2;
+}
@@ -0,0 +1,235 @@
+#include "StreamingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @param functions OpenGL functions of the current context
+ * @param target buffer binding target, e.g. GL_ARRAY_BUFFER
+ * @param usage usage hint of the storage, GL_STREAM_DRAW for streamed data
+ */
+StreamingBuffer::StreamingBuffer( QOpenGLFunctions_4_3_Core & functions,
+                                  GLenum target,
+                                  GLenum usage )
+    : functions(functions)
+    , target(target)
+    , usage(usage)
+    , id(0)
+    , capacity(0)
+    , head(0)
+    , lastRange{ 0, 0, nullptr }
+{
+    functions.glGenBuffers( 1, &id );
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+    releaseFences();
+    functions.glDeleteBuffers( 1, &id );
+}
+
+void StreamingBuffer::bind()
+{
+    functions.glBindBuffer( target, id );
+}
+
+GLuint StreamingBuffer::getId() const
+{
+    return id;
+}
+
+GLsizeiptr StreamingBuffer::getCapacity() const
+{
+    return capacity;
+}
+
+/**
+ * @brief replaces the whole content, storage is orphaned and reused when it is large enough
+ * but not much larger than the data, otherwise it is reallocated with the size of the data
+ * @param DATA data to upload
+ * @param size size of the data in bytes
+ */
+void StreamingBuffer::assign( const void * DATA,
+                              GLsizeiptr size )
+{
+    bind();
+    //orphaning re-specifies the whole capacity, storage left over from a much larger content is given back
+    if ( size > capacity || size < capacity / 4 )
+    {
+        reserve(size);
+    }
+    else
+    {
+        orphan();
+    }
+    if ( size > 0 )
+    {
+        functions.glBufferSubData( target, 0, size, DATA );
+    }
+}
+
+/**
+ * @brief overwrites a part of the content uploaded by assign()
+ * @param offset offset in bytes
+ * @param DATA data to upload
+ * @param size size of the data in bytes, offset + size must not exceed the assigned size
+ */
+void StreamingBuffer::updateRange( GLintptr offset,
+                                   const void * DATA,
+                                   GLsizeiptr size )
+{
+    bind();
+    functions.glBufferSubData( target, offset, size, DATA );
+}
+
+/**
+ * @brief copies data into the next free region of the ring, call fence() after the draw calls reading it
+ * @param DATA data to upload
+ * @param size size of the data in bytes
+ * @param alignment alignment of the region in bytes, vertex size so that the offset divided by it is the first vertex
+ * @return offset of the region in bytes
+ */
+GLintptr StreamingBuffer::stream( const void * DATA,
+                                  GLsizeiptr size,
+                                  GLsizeiptr alignment )
+{
+    bind();
+    GLintptr offset = ( head + alignment - 1 ) / alignment * alignment;
+    if ( size > capacity )
+    {
+        //ring holds a few regions of the largest size streamed so far
+        reserve( std::max( size * 4, capacity * 2 ) );
+        offset = 0;
+    }
+    else if ( offset + size > capacity )
+    {
+        offset = 0;
+    }
+    if ( !isRangeAvailable( offset, offset + size ) )
+    {
+        orphan();
+        offset = 0;
+    }
+
+    if ( size > 0 )
+    {
+        void * mapped = functions.glMapBufferRange( target, offset, size,
+                                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT );
+        if (mapped)
+        {
+            std::memcpy( mapped, DATA, size );
+            functions.glUnmapBuffer(target);
+        }
+        else
+        {
+            functions.glBufferSubData( target, offset, size, DATA );
+        }
+    }
+    head = offset + size;
+    lastRange = FencedRange{ offset, offset + size, nullptr };
+    unfencedRanges.push_back(lastRange);
+    return offset;
+}
+
+/**
+ * @brief protects regions streamed since the last fence and the region streamed last from being overwritten
+ * until the GPU completes the commands issued so far
+ */
+void StreamingBuffer::fence()
+{
+    if ( lastRange.end == lastRange.begin )
+    {
+        return;
+    }
+    if ( unfencedRanges.empty() )
+    {
+        unfencedRanges.push_back(lastRange);
+    }
+    for ( const FencedRange & RANGE : unfencedRanges )
+    {
+        //a newer fence of the same region supersedes the older one
+        auto sameRange = std::find_if( fencedRanges.begin(), fencedRanges.end(), [&RANGE]( const FencedRange & FENCED ) {
+            return FENCED.begin == RANGE.begin && FENCED.end == RANGE.end;
+        } );
+        GLsync sync = functions.glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+        if ( sameRange != fencedRanges.end() )
+        {
+            functions.glDeleteSync( sameRange->sync );
+            sameRange->sync = sync;
+        }
+        else
+        {
+            fencedRanges.push_back( FencedRange{ RANGE.begin, RANGE.end, sync } );
+        }
+    }
+    unfencedRanges.clear();
+}
+
+/**
+ * @brief reallocates the storage, previous content is dropped
+ * @param size new capacity in bytes
+ */
+void StreamingBuffer::reserve( GLsizeiptr size )
+{
+    capacity = size;
+    orphan();
+}
+
+/**
+ * @brief detaches the storage from the buffer, the driver keeps it alive for the pending commands and hands out a fresh one
+ */
+void StreamingBuffer::orphan()
+{
+    functions.glBufferData( target, capacity, nullptr, usage );
+    releaseFences();
+    unfencedRanges.clear();
+    head = 0;
+}
+
+/**
+ * @brief checks without waiting whether the GPU no longer reads the region, completed fences are released
+ * @param begin first byte of the region
+ * @param end byte after the region
+ */
+bool StreamingBuffer::isRangeAvailable( GLintptr begin,
+                                        GLintptr end )
+{
+    auto overlaps = [begin, end]( const FencedRange & RANGE ) {
+        return RANGE.begin < end && begin < RANGE.end;
+    };
+    //regions streamed but not fenced yet may still be drawn from
+    if ( std::any_of( unfencedRanges.begin(), unfencedRanges.end(), overlaps ) )
+    {
+        return false;
+    }
+    bool available = true;
+    for ( auto range = fencedRanges.begin(); range != fencedRanges.end(); )
+    {
+        if ( !overlaps(*range) )
+        {
+            ++range;
+            continue;
+        }
+        GLenum status = functions.glClientWaitSync( range->sync, 0, 0 );
+        if ( status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED )
+        {
+            functions.glDeleteSync( range->sync );
+            range = fencedRanges.erase(range);
+        }
+        else
+        {
+            available = false;
+            ++range;
+        }
+    }
+    return available;
+}
+
+void StreamingBuffer::releaseFences()
+{
+    for ( const FencedRange & RANGE : fencedRanges )
+    {
+        functions.glDeleteSync( RANGE.sync );
+    }
+    fencedRanges.clear();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QOpenGLFunctions_4_3_Core>
+#include <vector>
+
+/**
+ * @brief OpenGL buffer object shared by all views for data which is rewritten often.
+ * Data either persists in the buffer and is changed by sub-ranges (assign, updateRange),
+ * or is streamed into a ring of the buffer storage (stream) and read with the returned offset.
+ * Ring regions are protected by fences placed after the draw calls reading them: a region still in use by the GPU
+ * is never waited for, the whole storage is orphaned instead, so the driver hands out fresh memory without a stall.
+ * Storage is reused while the data fits and takes at least a quarter of it, so repeated updates of similar sizes never reallocate
+ * @note buffer is bound to its target by every call, element array buffers must be used with the owning vertex array object bound
+ */
+class StreamingBuffer
+{
+public:
+    StreamingBuffer( QOpenGLFunctions_4_3_Core & functions,
+                     GLenum target,
+                     GLenum usage );
+    ~StreamingBuffer();
+    StreamingBuffer( const StreamingBuffer & ) = delete;
+    StreamingBuffer & operator=( const StreamingBuffer & ) = delete;
+    void bind();
+    GLuint getId() const;
+    GLsizeiptr getCapacity() const;
+    void assign( const void * DATA,
+                 GLsizeiptr size );
+    void updateRange( GLintptr offset,
+                      const void * DATA,
+                      GLsizeiptr size );
+    GLintptr stream( const void * DATA,
+                     GLsizeiptr size,
+                     GLsizeiptr alignment );
+    void fence();
+
+private:
+    struct FencedRange
+    {
+        GLintptr begin;
+        GLintptr end;
+        GLsync sync;
+    };
+
+    void reserve( GLsizeiptr size );
+    void orphan();
+    bool isRangeAvailable( GLintptr begin,
+                           GLintptr end );
+    void releaseFences();
+
+private:
+    QOpenGLFunctions_4_3_Core & functions;
+    GLenum target;
+    GLenum usage;
+    GLuint id;
+    GLsizeiptr capacity;
+    //end of the last streamed region, next region starts after it
+    GLintptr head;
+    //regions streamed since the last fence and the region streamed last, which is the one being drawn
+    std::vector<FencedRange> unfencedRanges;
+    FencedRange lastRange;
+    std::vector<FencedRange> fencedRanges;
+};
@@ -0,0 +1,40 @@
+#include "UniformLocationCache.h"
+
+#include <QOpenGLShaderProgram>
+
+namespace
+{
+    //names in the order of UNIFORM values
+    const char * const UNIFORM_NAMES[UniformLocationCache::UNIFORMS_COUNT] = { "u_color",
+                                                                              "u_applyHeightColoring",
+                                                                              "u_separateHeights",
+                                                                              "u_heights",
+                                                                              "u_origin",
+                                                                              "u_precision",
+                                                                              "u_columnStrips" };
+}
+
+UniformLocationCache::UniformLocationCache()
+{
+    for ( int & location : locations )
+    {
+        location = -1;
+    }
+}
+
+/**
+ * @brief looks up locations of all known uniforms
+ * @param shaderProgram linked shader program
+ */
+void UniformLocationCache::resolve( QOpenGLShaderProgram & shaderProgram )
+{
+    for ( int uniform = 0; uniform < UNIFORMS_COUNT; uniform++ )
+    {
+        locations[uniform] = shaderProgram.uniformLocation( UNIFORM_NAMES[uniform] );
+    }
+}
+
+int UniformLocationCache::operator[]( UNIFORM uniform ) const
+{
+    return locations[uniform];
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+class QOpenGLShaderProgram;
+
+/**
+ * @brief Locations of the uniforms used by the grid and coordinate system programs, resolved once after linking,
+ * so that drawing looks them up by index instead of by name. Uniforms a program does not have are -1 and ignored by Qt
+ */
+class UniformLocationCache
+{
+public:
+    enum UNIFORM
+    {
+        COLOR,
+        APPLY_HEIGHT_COLORING,
+        SEPARATE_HEIGHTS,
+        HEIGHTS,
+        ORIGIN,
+        PRECISION,
+        COLUMN_STRIPS,
+        UNIFORMS_COUNT
+    };
+
+    UniformLocationCache();
+    void resolve( QOpenGLShaderProgram & shaderProgram );
+    int operator[]( UNIFORM uniform ) const;
+
+private:
+    int locations[UNIFORMS_COUNT];
+};
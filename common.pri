@@ -0,0 +1,12 @@
+# Settings shared by every project of the HeightMatricesCoupling tree
+
+CONFIG += c++17
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# Matrix iterators and line views only check bounds through assert(), drop these checks in release builds
+CONFIG(release, debug|release): DEFINES += NDEBUG
@@ -4,6 +4,8 @@
 
 int main( int argc, char * argv[] )
 {
+    //all widgets share one group of OpenGL objects, so shader programs are built once
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
     QApplication a(argc, argv);
     AppWindow w;
     w.show();